@@ -0,0 +1,42 @@
+#define CGN_AI_ISR
+#include "cgnuino.h"
+
+CgnAI ai = CgnAI(A0, 2);
+CgnStopwatch watch;
+uint32_t count[2] = {0, 0};
+uint32_t sum[2] = {0, 0};
+
+void setup() {
+  Serial.begin(115200);
+  ai.begin(1000);
+}
+
+void loop() {
+  byte ch;
+  int v;
+
+  // every sample converted at 1 kHz, regardless of the loop
+  while ((v = ai.read(&ch)) >= 0) {
+    sum[ch] += v;
+    count[ch]++;
+  }
+
+  if (watch.get() >= 100) {
+    // samples and mean of each channel in 100 ms, latest values
+    for (byte i = 0; i < 2; i++) {
+      Serial.print(count[i]);
+      Serial.print('\t');
+      Serial.print(count[i] > 0 ? sum[i] / count[i] : 0);
+      Serial.print('\t');
+      Serial.print(ai.get(i));
+      Serial.print('\t');
+      sum[i] = 0;
+      count[i] = 0;
+    }
+    Serial.println(ai.overflow());
+    watch.lap();
+  }
+
+  // a busy loop does not disturb the sampling
+  delay(random(1, 10));
+}
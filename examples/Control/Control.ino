@@ -14,17 +14,17 @@ void setup() {
 }
 
 void loop() {
-  ctrl.update();
+  ctrl.poll();
   switch (ctrl.getCode()) {
     case 1:
-      time_light = ctrl.getValue().toInt();
+      time_light = ctrl.getInt();
       break;
     case 2:
-      time_dark = ctrl.getValue().toInt();
+      time_dark = ctrl.getInt();
       break;
     case 112:
       while (true) {
-        ctrl.update();
+        ctrl.poll();
         if (ctrl.getCode() == 112) {
           break;
         } else {
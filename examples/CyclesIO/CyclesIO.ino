@@ -0,0 +1,67 @@
+#include "cgnuino.h"
+#include "CgnCycles.h"
+
+CgnDI lever = CgnDI(2);
+CgnDI keys = CgnDI(22, 8);
+CgnDI bank = CgnDI(22, 8);
+CgnDO led = CgnDO(13);
+CgnDO leds = CgnDO(30, 8);
+CgnDOFast<30, 31, 32, 33, 34, 35, 36, 37> fastLeds = CgnDOFast<30, 31, 32, 33, 34, 35, 36, 37>();
+CgnAO ao = CgnAO(5);
+CgnAOFast<6> fastAo = CgnAOFast<6>();
+CgnTone tone1 = CgnTone(8);
+CgnCycles cyc = CgnCycles();
+
+void setup() {
+  Serial.begin(115200);
+  bank.batch();
+  CgnCycles::begin();
+
+  Serial.println(F("method\tcount\tmin\tmean\tmax\tns"));
+  cyc.measure([]() {});
+  cyc.out(F("(call)"));
+  cyc.measure([]() { digitalRead(2); });
+  cyc.out(F("digitalRead"));
+  cyc.measure([]() { digitalWrite(13, LOW); });
+  cyc.out(F("digitalWrite"));
+
+  cyc.measure([]() { lever.update(); });
+  cyc.out(F("CgnDI::update 1 pin"));
+  cyc.measure([]() { keys.update(); });
+  cyc.out(F("CgnDI::update 8 pins"));
+  cyc.measure([]() { bank.update(); });
+  cyc.out(F("CgnDI::update 8 pins batch"));
+  cyc.measure([]() { keys.turnonMask(); });
+  cyc.out(F("CgnDI::turnonMask"));
+
+  cyc.measure([]() { led.update(); });
+  cyc.out(F("CgnDO::update 1 pin"));
+  cyc.measure([]() { leds.update(); });
+  cyc.out(F("CgnDO::update 8 pins"));
+  cyc.measure([]() { leds.out(0, 100); });
+  cyc.out(F("CgnDO::out"));
+  cyc.measure([]() { leds.outMask(0xFF, 100); });
+  cyc.out(F("CgnDO::outMask 8 pins"));
+  cyc.measure([]() { fastLeds.update(); });
+  cyc.out(F("CgnDOFast::update 8 pins"));
+  cyc.measure([]() { fastLeds.out(0, 100); });
+  cyc.out(F("CgnDOFast::out"));
+
+  cyc.measure([]() { ao.update(); });
+  cyc.out(F("CgnAO::update"));
+  cyc.measure([]() { ao.out(100, 128); });
+  cyc.out(F("CgnAO::out"));
+  cyc.measure([]() { fastAo.update(); });
+  cyc.out(F("CgnAOFast::update"));
+  cyc.measure([]() { fastAo.out(100, 128); });
+  cyc.out(F("CgnAOFast::out"));
+  cyc.measure([]() { tone1.update(); });
+  cyc.out(F("CgnTone::update"));
+  cyc.measure([]() { tone1.out(100, 2000); });
+  cyc.out(F("CgnTone::out"));
+
+  CgnCycles::end();
+}
+
+void loop() {
+}
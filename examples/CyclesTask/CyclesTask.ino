@@ -0,0 +1,59 @@
+#include "cgnuino.h"
+#include "CgnCycles.h"
+
+enum {REST, TRIAL};
+
+CgnState state = CgnState(F("rest\ttrial"));
+CgnPeriod period = CgnPeriod();
+CgnStopwatch watch = CgnStopwatch();
+CgnLogger logger = CgnLogger();
+CgnControl control = CgnControl();
+CgnData data = CgnData();
+CgnRecord<256> rec = CgnRecord<256>();
+CgnCycles cyc = CgnCycles();
+
+void setup() {
+  Serial.begin(115200);
+  state.set(TRIAL, 1000);
+  period.set("trial", 1000);
+  CgnCycles::begin();
+
+  Serial.println(F("method\tcount\tmin\tmean\tmax\tns"));
+  cyc.measure([]() {});
+  cyc.out(F("(call)"));
+  cyc.measure([]() { millis(); });
+  cyc.out(F("millis"));
+  cyc.measure([]() { cgnClock.now(); });
+  cyc.out(F("CgnClock::now"));
+  cyc.measure([]() { watch.get(); });
+  cyc.out(F("CgnStopwatch::get"));
+
+  cyc.measure([]() { state.is(REST); });
+  cyc.out(F("CgnState::is"));
+  cyc.measure([]() { state.expire(); });
+  cyc.out(F("CgnState::expire"));
+  cyc.measure([]() { state.set(TRIAL, 1000); });
+  cyc.out(F("CgnState::set"));
+  cyc.measure([]() { period.is("rest"); });
+  cyc.out(F("CgnPeriod::is"));
+  cyc.measure([]() { period.set("trial", 1000); });
+  cyc.out(F("CgnPeriod::set"));
+
+  cyc.measure([]() { logger.update(digitalRead(2)); });
+  cyc.out(F("CgnLogger::update"));
+  cyc.measure([]() { control.poll(); });
+  cyc.out(F("CgnControl::poll"));
+
+  // the rows are emitted to the serial port afterwards
+  cyc.measure([]() { data.append(String(123)); });
+  cyc.out(F("CgnData::append"));
+  cyc.measure([]() { rec.append(123); });
+  cyc.out(F("CgnRecord::append"));
+  data.clear();
+  rec.clear();
+
+  CgnCycles::end();
+}
+
+void loop() {
+}
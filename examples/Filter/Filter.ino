@@ -0,0 +1,39 @@
+#define CGN_AI_ISR
+#include "cgnuino.h"
+
+CgnAI piezo = CgnAI(A0);
+CgnFilter spike = CgnFilter(CGN_MEDIAN, 5);
+CgnFilter smooth = CgnFilter(CGN_IIR, 3);
+CgnFilter trace = CgnFilter(CGN_CIC, 50);
+CgnThreshold lick = CgnThreshold(600, 450, 13);
+CgnStopwatch watch;
+
+void setup() {
+  Serial.begin(115200);
+  piezo.begin(1000);
+}
+
+void loop() {
+  int v;
+
+  // every sample at 1 kHz is filtered, regardless of the loop
+  while ((v = piezo.read()) >= 0) {
+    spike.put(v);
+    smooth.put(spike.get());
+
+    // the trace decimated to 20 Hz
+    if (trace.put(v)) {
+      Serial.print(F("trace\t"));
+      Serial.println(trace.get());
+    }
+  }
+
+  // lick onsets with the LED on pin 13 relaying the state
+  lick.update(smooth);
+  if (lick.turnon()) {
+    Serial.print(F("lick\t"));
+    Serial.println(watch.lap());
+  }
+
+  delay(random(1, 10));
+}
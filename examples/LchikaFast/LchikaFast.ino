@@ -0,0 +1,23 @@
+#include "cgnuino.h"
+
+CgnStopwatch sw;
+CgnDOFast<13, 8, 4, 2> led = CgnDOFast<13, 8, 4, 2>();
+CgnAOFast<9> lamp = CgnAOFast<9>();
+
+void setup() {
+  Serial.begin(115200);
+}
+
+void loop() {
+  led.update();
+  lamp.update();
+  if (sw.get() > 2000) {
+    sw.lap();
+    led.out(0, 500);
+    led.out(1, 600);
+    led.out(2, 1000);
+    led.out(3, 1500);
+    lamp.out(1000, 64);
+  }
+  delay(1);
+}
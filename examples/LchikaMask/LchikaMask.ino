@@ -0,0 +1,26 @@
+#include "cgnuino.h"
+
+const byte pins[] = {13, 8, 4, 2};
+CgnStopwatch sw;
+CgnDO led = CgnDO(pins);
+bool later = false;
+
+void setup() {
+  Serial.begin(115200);
+}
+
+void loop() {
+  led.update();
+  if (sw.get() > 2000) {
+    sw.lap();
+    // pins 13 and 4 turn on together
+    led.outMask(0b0101, 500);
+    later = true;
+  }
+  if (later && sw.get() > 1000) {
+    // then pins 8 and 2
+    led.outMask(0b1010, 1000);
+    later = false;
+  }
+  delay(1);
+}
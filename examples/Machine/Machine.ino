@@ -0,0 +1,52 @@
+#include "cgnuino.h"
+
+enum {REST, PRETRIAL, TRIAL, REWARD, ITI};
+
+const CgnMachine::Stage stages[] PROGMEM = {
+  // time limit, state on expiration
+  {ULONG_MAX, REST}, // REST
+  {500, TRIAL},      // PRETRIAL
+  {2000, ITI},       // TRIAL
+  {300, ITI},        // REWARD
+  {1000, REST},      // ITI
+};
+
+const CgnMachine::Rule rules[] PROGMEM = {
+  // source state, input channel, condition, target state
+  {REST, 0, CGN_TURNON, PRETRIAL},
+  {PRETRIAL, 0, CGN_TURNOFF, ITI},
+  {TRIAL, 1, CGN_TURNON, REWARD},
+};
+
+CgnDI button = CgnDI(2, 2);
+CgnDO led = CgnDO(13);
+CgnMachine task = CgnMachine(stages, countof(stages), rules, countof(rules),
+  F("rest\tpretrial\ttrial\treward\titi"));
+
+void setup() {
+  Serial.begin(115200);
+  task.set(REST);
+}
+
+void loop() {
+  button.update();
+  led.update();
+
+  if (task.step(button)) {
+    Serial.print(task.since());
+    Serial.print("\t");
+    task.printName(Serial);
+    Serial.println("");
+
+    switch (task.get()) {
+      case TRIAL:
+        led.out(0, 2000);
+        break;
+      case REWARD:
+      case ITI:
+        led.out(0, 0);
+        break;
+    }
+  }
+  delay(1);
+}
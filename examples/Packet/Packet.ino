@@ -0,0 +1,24 @@
+#include "cgnuino.h"
+
+CgnStopwatch sw;
+CgnDI button = CgnDI(2);
+CgnPacket pkt = CgnPacket(F("HLf"), F("trial\trt\tvoltage"));
+uint16_t trial = 0;
+
+void setup() {
+  Serial.begin(115200);
+  pkt.begin();
+}
+
+void loop() {
+  button.update();
+
+  if (button.turnon()) {
+    trial += 1;
+    pkt.append(trial);
+    pkt.append(sw.lap());
+    pkt.append(analogRead(A0) * 5.0 / 1023.0);
+    pkt.out();
+  }
+  delay(1);
+}
@@ -0,0 +1,26 @@
+#include "cgnuino.h"
+
+CgnProfiler prof = CgnProfiler(1000);
+CgnStopwatch watch;
+
+void setup() {
+  Serial.begin(115200);
+  prof.start();
+}
+
+void loop() {
+  prof.lap();
+
+  if (watch.get() >= 5000) {
+    // count, mean, min, p50, p95, p99, max, overrun [us]
+    prof.out(true);
+    prof.start();
+    watch.lap();
+  }
+
+  if (random(100) == 0) {
+    delayMicroseconds(random(500, 2000));
+  } else {
+    delayMicroseconds(random(50, 200));
+  }
+}
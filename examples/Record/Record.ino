@@ -0,0 +1,27 @@
+#include "cgnuino.h"
+
+CgnStopwatch sw;
+CgnDI button = CgnDI(2);
+CgnRecord<64> rec;
+long trial = 0;
+
+void setup() {
+  Serial.begin(115200);
+}
+
+void loop() {
+  button.update();
+
+  if (button.turnon()) {
+    trial += 1;
+    rec.append(F("press"));
+    rec.append(trial);
+    rec.append(sw.lap());
+    rec.append(analogRead(A0) * 5.0 / 1023.0, 3);
+    if (rec.overflow()) {
+      Serial.println(F("record overflowed"));
+    }
+    rec.out();
+  }
+  delay(1);
+}
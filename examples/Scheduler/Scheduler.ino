@@ -0,0 +1,32 @@
+#include "cgnuino.h"
+
+CgnStopwatch sw;
+CgnDO led = CgnDO(8, 4);
+CgnTone buzzer = CgnTone(7);
+
+void setup() {
+  Serial.begin(115200);
+  cgnScheduler.begin();
+}
+
+void loop() {
+  uint32_t late;
+
+  late = cgnScheduler.update();
+  if (late != ULONG_MAX) {
+    Serial.print(cgnScheduler.fired());
+    Serial.print(" output(s) terminated, ");
+    Serial.print(late);
+    Serial.println(" ms late");
+  }
+
+  if (sw.get() > 2000) {
+    sw.lap();
+    led.out(0, 500);
+    led.out(1, 600);
+    led.out(2, 1000);
+    led.out(3, 1500);
+    buzzer.out(100, 880);
+  }
+  delay(1);
+}
@@ -0,0 +1,35 @@
+#define CGN_AI_ISR
+#include "cgnuino.h"
+
+enum {TRIAL, ITI};
+
+CgnAI force = CgnAI(A0);
+CgnDI lever = CgnDI(2);
+CgnEdges edges;
+CgnSnapshot<600> snap = CgnSnapshot<600>(force, lever, 0, CGN_TURNON, 200, 300);
+CgnState state = CgnState(F("trial\titi"));
+CgnData data = CgnData();
+
+void setup() {
+  Serial.begin(115200);
+  lever.attach(edges);
+  force.begin(1000);
+  state.set(TRIAL);
+}
+
+void loop() {
+  lever.update();
+  snap.update();
+
+  if (state.is(TRIAL) && snap.ready()) {
+    // 200 ms before and 300 ms after the press are frozen
+    state.set(ITI, 2000);
+
+  } else if (state.is(ITI)) {
+    // a row in each loop, while nothing else is going on
+    snap.out(data);
+    if (state.expire()) {
+      state.set(TRIAL);
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#include "cgnuino.h"
+
+enum {REST, PRETRIAL, TRIAL, ITI};
+
+CgnState state = CgnState(F("rest\tpretrial\ttrial\titi"));
+
+void setup() {
+  Serial.begin(115200);
+  state.set(REST);
+}
+
+void loop() {
+  if (state.is(REST)) {
+    state.set(PRETRIAL, 500);
+    state.printName(Serial);
+    Serial.println("");
+
+  } else if (state.is(PRETRIAL) && state.expire()) {
+    state.set(TRIAL, 2000);
+    state.printName(Serial);
+    Serial.println(" progressing");
+
+  } else if (state.is(TRIAL) && state.expire()) {
+    state.set(ITI, 1000);
+    state.printName(Serial);
+    Serial.print(" from ");
+    Serial.println(state.since());
+
+  } else if (state.is(ITI) && state.expire()) {
+    state.set(REST);
+    Serial.println("");
+
+  }
+  delay(1);
+}
@@ -0,0 +1,38 @@
+#define CGN_AI_ISR
+#include "cgnuino.h"
+
+// fixation point and 8 targets around it, in raw values of the eye tracker
+const int TARGET_X[] = {812, 724, 512, 300, 212, 300, 512, 724};
+const int TARGET_Y[] = {512, 724, 812, 724, 512, 300, 212, 300};
+
+CgnAI eye = CgnAI(A0, 2);
+CgnWindow win = CgnWindow(20);
+
+void setup() {
+  Serial.begin(115200);
+  eye.begin(1000);
+
+  win.circle(0, 512, 512, 50);
+  for (byte i = 0; i < 8; i++) {
+    win.rect(i + 1, TARGET_X[i], TARGET_Y[i], 60, 60);
+  }
+}
+
+void loop() {
+  win.update(eye);
+
+  if (win.turnon(0)) {
+    Serial.println("fixation acquired");
+  } else if (win.turnoff(0)) {
+    Serial.println("fixation broken");
+  }
+
+  if (win.turnonMask() & 0x1FE) {
+    Serial.print("saccade to target ");
+    for (byte i = 1; i <= 8; i++) {
+      if (win.turnon(i)) {
+        Serial.println(i);
+      }
+    }
+  }
+}
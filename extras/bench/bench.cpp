@@ -0,0 +1,307 @@
+/*!
+ * @file bench.cpp
+ * @brief Microbenchmarks of the hot paths of cgnuino on the virtual board.
+ * @author Kei Mochizuki
+ *
+ * Each benchmark drives one method of a cgnuino class
+ * (the ones called in every \c loop or every trial of a task)
+ * repeatedly for a minimum wall-clock time,
+ * and reports the time and the heap allocations per call.
+ * The heap is counted by replacing the global \c operator \c new,
+ * so the numbers show how much the String-based methods
+ * (CgnData, CgnPeriod, CgnStrobe) cost beyond the buffer-based ones.
+ * Note that String of the host keeps texts shorter than 16 characters
+ * without the heap, unlike that of the Arduino,
+ * so give \c -l 16 or more to see the allocations made for names and fields.
+ *
+ * Absolute times are those of the host, not of the Arduino,
+ * and include the emulated core (e.g., \c digitalRead).
+ * They are meant to be compared between revisions
+ * on the same machine, for which the results are written as JSON.
+ *
+ * \code
+ * ./bench > base.json
+ * ./bench -c 8 -l 32 -m 500 -o wide.json
+ * ./bench -f CgnDI
+ * \endcode
+**/
+
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+namespace {
+
+/*!
+ * @brief Result of a benchmark.
+**/
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  double ns;
+  double allocs;
+  double bytes;
+};
+
+uint64_t nAlloc = 0;
+uint64_t nByte = 0;
+uint32_t minMs = 200;
+volatile uint32_t sink;
+
+/*!
+ * @brief Calls an operation repeatedly and measures it.
+ * @param name Name of the benchmark.
+ * @param op Operation to be measured (called with no argument).
+ * @return Time and heap usage per call.
+ * @note The number of calls doubles until the run takes \c minMs.
+**/
+template <typename F>
+Result measure(const char *name, F op) {
+  typedef std::chrono::steady_clock Clock;
+  Result r;
+  uint64_t n = 1;
+
+  op();
+  while (true) {
+    uint64_t a = nAlloc, b = nByte;
+    Clock::time_point t0 = Clock::now();
+    for (uint64_t i = 0; i < n; i++) {
+      op();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    if (ns >= minMs * 1e6 || n >= (1ULL << 40)) {
+      r.name = name;
+      r.iterations = n;
+      r.ns = ns / n;
+      r.allocs = (double)(nAlloc - a) / n;
+      r.bytes = (double)(nByte - b) / n;
+      return r;
+    }
+    n *= 2;
+  }
+}
+
+/*!
+ * @brief Makes a text of a given length.
+ * @param len Number of characters.
+ * @param last Character placed at the end.
+ * @return Text such as "aaaa...z".
+**/
+std::string text(byte len, char last) {
+  std::string s(len, 'a');
+  if (len > 0) {
+    s[len - 1] = last;
+  }
+  return s;
+}
+
+}  // namespace
+
+void *operator new(size_t size) {
+  void *p = malloc(size > 0 ? size : 1);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  nAlloc++;
+  nByte += size;
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [-c channels] [-l length] [-m min_ms] [-f filter] [-o file]\n"
+          "  -c  number of pins of CgnDI/CgnDO (up to 32) and fields of a row (default 4)\n"
+          "  -l  length of names, fields and texts (default 8)\n"
+          "  -m  minimum time of each benchmark in [ms] (default 200)\n"
+          "  -f  run only the benchmarks whose names contain the filter\n"
+          "  -o  write the results to a file instead of the standard output\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  byte ch = 4;
+  byte len = 8;
+  const char *filter = "";
+  const char *path = NULL;
+  std::vector<Result> results;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      int c = atoi(argv[++i]);
+      ch = constrain(c, 1, 32);
+    } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      int l = atoi(argv[++i]);
+      len = constrain(l, 1, 200);
+    } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+      minMs = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  hostSerialOutput(NULL);
+
+  std::string name = text(len, 'z');
+  std::string other = text(len, 'y');
+  std::string field = text(len, '0');
+  std::string line = "12:" + std::string(len, '7') + "\n";
+  auto wanted = [&](const char *s) { return strstr(s, filter) != NULL; };
+
+  if (wanted("CgnDI::update")) {
+    CgnDIBank<32> di = CgnDIBank<32>(22, ch);
+    results.push_back(measure("CgnDI::update", [&]() {
+      sink = di.update();
+    }));
+  }
+  if (wanted("CgnDI::update/edge")) {
+    // every call sees a change, including the cost of driving the pin
+    CgnDIBank<32> di = CgnDIBank<32>(22, ch, 0, 0);
+    int level = LOW;
+    results.push_back(measure("CgnDI::update/edge", [&]() {
+      hostSetPin(22, level);
+      level = !level;
+      sink = di.update() + di.turnon();
+    }));
+  }
+  if (wanted("CgnDO::update")) {
+    CgnDOBank<32> dout = CgnDOBank<32>(30, ch);
+    for (byte i = 0; i < ch; i++) {
+      dout.out(i, 1000);
+    }
+    results.push_back(measure("CgnDO::update", [&]() {
+      sink = dout.update();
+    }));
+  }
+  if (wanted("CgnData::append")) {
+    // one row of the given number of fields
+    CgnData data = CgnData();
+    String s = field.c_str();
+    results.push_back(measure("CgnData::append", [&]() {
+      for (byte i = 0; i < ch; i++) {
+        data.append(s);
+      }
+      data.out();
+    }));
+  }
+  if (wanted("CgnRecord::append")) {
+    // the same row without heap
+    CgnRecord<N_CGNPACKET * 4> rec = CgnRecord<N_CGNPACKET * 4>();
+    results.push_back(measure("CgnRecord::append", [&]() {
+      for (byte i = 0; i < ch; i++) {
+        rec.append(field.c_str());
+      }
+      rec.out();
+    }));
+  }
+  if (wanted("CgnControl::poll")) {
+    CgnControl control = CgnControl();
+    results.push_back(measure("CgnControl::poll", [&]() {
+      sink = control.poll();
+    }));
+  }
+  if (wanted("CgnControl::poll/line")) {
+    // a variable modulation command arriving in every call
+    CgnControl control = CgnControl();
+    results.push_back(measure("CgnControl::poll/line", [&]() {
+      hostSerialInput(line.c_str());
+      sink = control.poll() + control.getCode();
+    }));
+  }
+  if (wanted("CgnPeriod::is")) {
+    // mismatch at the last character, as in if-else chains of periods
+    CgnPeriod period = CgnPeriod();
+    period.set(name.c_str());
+    results.push_back(measure("CgnPeriod::is", [&]() {
+      sink = period.is(other.c_str());
+    }));
+  }
+  if (wanted("CgnPeriod::set")) {
+    CgnPeriod period = CgnPeriod();
+    results.push_back(measure("CgnPeriod::set", [&]() {
+      period.set(name.c_str(), 1000);
+    }));
+  }
+  if (wanted("CgnState::is")) {
+    CgnState state = CgnState();
+    state.set(3);
+    results.push_back(measure("CgnState::is", [&]() {
+      sink = state.is(2) + state.expire();
+    }));
+  }
+  if (wanted("CgnWindow::update")) {
+    // windows on a ring, with a position wandering across them
+    CgnWindow win = CgnWindow();
+    int x = 0;
+    for (byte i = 0; i < N_CGNWINDOW; i++) {
+      if (i % 2 == 0) {
+        win.circle(i, 64 * i, 512, 40);
+      } else {
+        win.rect(i, 64 * i, 512, 40, 40);
+      }
+    }
+    results.push_back(measure("CgnWindow::update", [&]() {
+      x = (x + 7) & 1023;
+      sink = win.update(x, 500) + win.onMask();
+    }));
+  }
+  if (wanted("CgnFilter::put")) {
+    // one sample through each kind of filter
+    CgnFilter iir = CgnFilter(CGN_IIR, 4);
+    CgnFilter mean = CgnFilter(CGN_MEAN, 10);
+    CgnFilter median = CgnFilter(CGN_MEDIAN, 5);
+    CgnFilter cic = CgnFilter(CGN_CIC, 10);
+    int v = 0;
+    results.push_back(measure("CgnFilter::put", [&]() {
+      v = (v + 337) & 1023;
+      iir.put(v);
+      mean.put(v);
+      median.put(v);
+      cic.put(v);
+      sink = iir.get() + mean.get() + median.get() + cic.get();
+    }));
+  }
+  if (wanted("CgnStrobe::out")) {
+    // the strobe is waited for in virtual time, which costs little on the host
+    CgnStrobe strobe = CgnStrobe(30, 1);
+    String s = field.c_str();
+    results.push_back(measure("CgnStrobe::out", [&]() {
+      sink = strobe.out(s);
+    }));
+  }
+
+  FILE *fp = (path == NULL) ? stdout : fopen(path, "w");
+  if (fp == NULL) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return 1;
+  }
+  fprintf(fp, "{\n  \"channels\": %u,\n  \"length\": %u,\n  \"min_ms\": %lu,\n  \"results\": [",
+          ch, len, (unsigned long)minMs);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &r = results[i];
+    fprintf(fp, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f,"
+            " \"allocs_per_op\": %.3f, \"heap_bytes_per_op\": %.1f}",
+            (i == 0) ? "" : ",", r.name.c_str(), (unsigned long long)r.iterations,
+            r.ns, r.allocs, r.bytes);
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  if (fp != stdout) {
+    fclose(fp);
+  }
+  return 0;
+}
@@ -0,0 +1,219 @@
+/*!
+ * @file cgndecode.cpp
+ * @brief Host-side decoder for binary packets emitted by CgnPacket class.
+ * @author Kei Mochizuki
+ *
+ * Reads a byte stream of COBS-framed packets (e.g., a serial device
+ * or a file dumped from it) and prints the records as tab-separated rows.
+ * A header row with the column names is printed whenever
+ * a schema descriptor is received.
+ * Corrupted packets and gaps in the sequence numbers are reported
+ * to the standard error.
+ *
+ * Build and run on Linux as below.
+ *
+ * \code
+ * c++ -O2 -o cgndecode cgndecode.cpp
+ * stty -F /dev/ttyACM0 115200 raw
+ * ./cgndecode /dev/ttyACM0 > session.tsv
+ * \endcode
+**/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*!
+ * @brief Computes CRC-16/CCITT-FALSE in the same way as CgnPacket class.
+ * @param p Data.
+ * @param n Length of the data.
+ * @return CRC of the data.
+**/
+static uint16_t crc16(const uint8_t *p, size_t n) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < n; i++) {
+    crc ^= (uint16_t)p[i] << 8;
+    for (int k = 0; k < 8; k++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+/*!
+ * @brief Decodes a COBS-encoded frame (without the terminating zero).
+ * @param in Encoded frame.
+ * @param out Decoded packet.
+ * @return Whether the frame was well-formed.
+**/
+static bool unstuff(const std::vector<uint8_t> &in, std::vector<uint8_t> &out) {
+  size_t i = 0;
+  out.clear();
+  while (i < in.size()) {
+    uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > in.size()) {
+      return false;
+    }
+    out.insert(out.end(), in.begin() + i, in.begin() + i + code - 1);
+    i += code - 1;
+    if (code < 0xFF && i < in.size()) {
+      out.push_back(0);
+    }
+  }
+  return true;
+}
+
+/*!
+ * @brief Decoder state for a stream of packets.
+**/
+class Decoder {
+  public:
+    Decoder(FILE *output) : out(output), known(false), started(false), expect(0), bad(0), lost(0) {}
+
+    /*!
+     * @brief Handles a frame received from the stream.
+     * @param frame COBS-encoded frame (without the terminating zero).
+    **/
+    void handle(const std::vector<uint8_t> &frame) {
+      std::vector<uint8_t> p;
+      if (frame.empty()) {
+        return;
+      }
+      if (!unstuff(frame, p) || p.size() < 3 ||
+          crc16(p.data(), p.size() - 2) != (p[p.size() - 2] | (p[p.size() - 1] << 8))) {
+        bad++;
+        fprintf(stderr, "cgndecode: corrupted packet dropped\n");
+        return;
+      }
+      p.resize(p.size() - 2);
+      if (p[0] == 'S') {
+        schema(p);
+      } else if (p[0] == 'R') {
+        record(p);
+      }
+    }
+
+    /*!
+     * @brief Shows the number of corrupted packets.
+     * @return Number of packets dropped for CRC or framing errors.
+    **/
+    unsigned long corrupted() const {
+      return bad;
+    }
+
+    /*!
+     * @brief Shows the number of records missed.
+     * @return Number of records inferred from gaps in sequence numbers.
+    **/
+    unsigned long missed() const {
+      return lost;
+    }
+
+  private:
+    void schema(const std::vector<uint8_t> &p) {
+      if (p.size() < 3 || p[1] != 1 || p.size() < 3u + p[2]) {
+        fprintf(stderr, "cgndecode: unsupported schema\n");
+        return;
+      }
+      types.assign(p.begin() + 3, p.begin() + 3 + p[2]);
+      std::string names(p.begin() + 3 + p[2], p.end());
+      known = true;
+      started = false;
+      if (names.empty()) {
+        for (size_t i = 0; i < types.size(); i++) {
+          names += (i ? "\t" : "") + std::string("col") + std::to_string(i + 1);
+        }
+      }
+      fprintf(out, "%s\n", names.c_str());
+      fflush(out);
+    }
+
+    void record(const std::vector<uint8_t> &p) {
+      size_t at = 3;
+      uint16_t seq;
+      if (!known) {
+        fprintf(stderr, "cgndecode: record before schema dropped\n");
+        return;
+      }
+      seq = p[1] | (p[2] << 8);
+      if (expect != seq && started) {
+        lost += (uint16_t)(seq - expect);
+        fprintf(stderr, "cgndecode: %u record(s) missed\n", (uint16_t)(seq - expect));
+      }
+      started = true;
+      expect = seq + 1;
+
+      std::string row;
+      for (size_t c = 0; c < types.size(); c++) {
+        char t = types[c];
+        size_t w = (t == 'b' || t == 'B') ? 1 : (t == 'h' || t == 'H') ? 2 : 4;
+        if (at + w > p.size()) {
+          fprintf(stderr, "cgndecode: record shorter than schema dropped\n");
+          return;
+        }
+        uint32_t v = 0;
+        for (size_t k = 0; k < w; k++) {
+          v |= (uint32_t)p[at + k] << (8 * k);
+        }
+        at += w;
+
+        char s[32];
+        switch (t) {
+          case 'b': snprintf(s, sizeof(s), "%d", (int)(int8_t)v); break;
+          case 'B': snprintf(s, sizeof(s), "%u", (unsigned)(uint8_t)v); break;
+          case 'h': snprintf(s, sizeof(s), "%d", (int)(int16_t)v); break;
+          case 'H': snprintf(s, sizeof(s), "%u", (unsigned)(uint16_t)v); break;
+          case 'l': snprintf(s, sizeof(s), "%ld", (long)(int32_t)v); break;
+          case 'L': snprintf(s, sizeof(s), "%lu", (unsigned long)v); break;
+          case 'f': {
+            float f;
+            memcpy(&f, &v, 4);
+            snprintf(s, sizeof(s), "%.7g", f);
+            break;
+          }
+          default: snprintf(s, sizeof(s), "?"); break;
+        }
+        row += (c ? "\t" : "") + std::string(s);
+      }
+      fprintf(out, "%s\n", row.c_str());
+      fflush(out);
+    }
+
+    FILE *out;
+    bool known;
+    bool started;
+    std::string types;
+    uint16_t expect;
+    unsigned long bad;
+    unsigned long lost;
+};
+
+int main(int argc, char **argv) {
+  FILE *in = stdin;
+  if (argc > 1 && strcmp(argv[1], "-") != 0) {
+    in = fopen(argv[1], "rb");
+    if (in == NULL) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  Decoder dec(stdout);
+  std::vector<uint8_t> frame;
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (c == 0) {
+      dec.handle(frame);
+      frame.clear();
+    } else {
+      frame.push_back((uint8_t)c);
+    }
+  }
+  if (dec.corrupted() > 0 || dec.missed() > 0) {
+    fprintf(stderr, "cgndecode: %lu corrupted packet(s), %lu missed record(s)\n",
+      dec.corrupted(), dec.missed());
+  }
+  return 0;
+}
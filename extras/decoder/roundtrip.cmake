@@ -0,0 +1,33 @@
+# Round trip of CgnPacket through the host build and the decoder.
+#
+# Runs the Packet example on the virtual board with scripted button
+# presses, decodes its serial output by cgndecode, and compares the
+# rows with the expected ones. Invoked by ctest (see CMakeLists.txt).
+#
+#   cmake -DSKETCH=... -DDECODER=... -DSCRIPT=... -DEXPECTED=... -DOUTPUT=... -P roundtrip.cmake
+
+execute_process(
+  COMMAND ${SKETCH} -t 5 -s ${SCRIPT}
+  COMMAND ${DECODER}
+  OUTPUT_FILE ${OUTPUT}
+  ERROR_VARIABLE log
+  RESULTS_VARIABLE codes)
+
+foreach(code ${codes})
+  if(NOT code EQUAL 0)
+    message(FATAL_ERROR "round trip failed (exit codes: ${codes})\n${log}")
+  endif()
+endforeach()
+if(NOT log STREQUAL "")
+  # the decoder reports corrupted packets and sequence gaps here
+  message(FATAL_ERROR "decoder complained:\n${log}")
+endif()
+
+execute_process(
+  COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT} ${EXPECTED}
+  RESULT_VARIABLE differ)
+if(differ)
+  file(READ ${OUTPUT} got)
+  file(READ ${EXPECTED} want)
+  message(FATAL_ERROR "decoded rows differ\n--- got\n${got}--- expected\n${want}")
+endif()
@@ -0,0 +1,658 @@
+/*!
+ * @file Arduino.cpp
+ * @brief Virtual board behind the emulated Arduino core.
+ * @author Kei Mochizuki
+**/
+
+#include "Arduino.h"
+
+#include <deque>
+#include <map>
+#include <set>
+
+namespace {
+
+constexpr int N_IRQ = 6;
+constexpr uint8_t IRQ_PIN[N_IRQ] = {2, 3, 21, 20, 19, 18};
+
+struct Event {
+  char kind;
+  uint8_t pin;
+  int value;
+  std::string text;
+};
+
+struct Board {
+  uint64_t now = 0;
+  uint32_t loopCost = 10;
+  uint64_t jump = 0;
+  bool busy = false;
+  std::set<uint64_t> deadlines;
+  uint8_t mode[NUM_DIGITAL_PINS] = {};
+  uint8_t latch[NUM_DIGITAL_PINS] = {};
+  int drive[NUM_DIGITAL_PINS];
+  int pwm[NUM_DIGITAL_PINS] = {};
+  unsigned int freq[NUM_DIGITAL_PINS] = {};
+  int toneId[NUM_DIGITAL_PINS] = {};
+  int analog[NUM_ANALOG_INPUTS] = {};
+  void (*isr[N_IRQ])() = {};
+  int isrMode[N_IRQ] = {};
+  bool inIsr = false;
+  void (*timer)() = NULL;
+  uint64_t nextTick = 0;
+  void (*adc)() = NULL;
+  uint32_t adcPeriod = 0;
+  uint64_t nextAdc = 0;
+  std::multimap<uint64_t, Event> events;
+  std::deque<uint8_t> rx;
+  FILE *out = stdout;
+  void (*sink)(const char *, void *) = NULL;
+  void *sinkObj = NULL;
+  std::string line;
+  uint32_t seed = 1;
+
+  Board() {
+    for (int i = 0; i < NUM_DIGITAL_PINS; i++) {
+      drive[i] = -1;
+    }
+  }
+};
+
+// constructed on first use, since sketches touch pins in their global constructors,
+// and one for each thread, so that threads run independent boards
+Board &board() {
+  static thread_local Board b;
+  return b;
+}
+
+bool valid(uint8_t pin) {
+  return pin < NUM_DIGITAL_PINS;
+}
+
+int level(uint8_t pin) {
+  Board &b = board();
+  if (b.mode[pin] == OUTPUT) {
+    return b.latch[pin];
+  }
+  if (b.drive[pin] >= 0) {
+    return b.drive[pin];
+  }
+  return (b.mode[pin] == INPUT_PULLUP) ? HIGH : LOW;
+}
+
+// calls the interrupt attached to the pin if the level change matches its mode
+void trigger(uint8_t pin, int from, int to) {
+  Board &b = board();
+  if (from == to || b.inIsr) {
+    return;
+  }
+  for (int k = 0; k < N_IRQ; k++) {
+    if (IRQ_PIN[k] != pin || b.isr[k] == NULL) {
+      continue;
+    }
+    int m = b.isrMode[k];
+    if (m == CHANGE || (m == RISING && to == HIGH) || (m == FALLING && to == LOW)) {
+      b.inIsr = true;
+      b.isr[k]();
+      b.inIsr = false;
+    }
+  }
+}
+
+void apply(const Event &e) {
+  Board &b = board();
+  b.busy = true;
+  switch (e.kind) {
+    case 'p':
+      hostSetPin(e.pin, e.value);
+      break;
+    case 'a':
+      hostSetAnalog(e.pin, e.value);
+      break;
+    case 's':
+      hostSerialInput(e.text.c_str());
+      break;
+    case 't':
+      if (b.toneId[e.pin] == e.value) {
+        b.freq[e.pin] = 0;
+      }
+      break;
+  }
+}
+
+void schedule(uint64_t us, char kind, uint8_t pin, int value, const char *text) {
+  Board &b = board();
+  Event e;
+  e.kind = kind;
+  e.pin = pin;
+  e.value = value;
+  e.text = (text == NULL) ? "" : text;
+  b.events.insert(std::make_pair(us, e));
+}
+
+// serves scheduled inputs, timer ticks and A/D conversions up to the target time,
+// or until a tick made the board busy when yielding
+void advance(uint64_t target, bool yield) {
+  Board &b = board();
+  while (true) {
+    uint64_t next = target + 1;
+    char kind = 'e';
+    if (!b.events.empty()) {
+      next = b.events.begin()->first;
+    }
+    if (b.timer != NULL && b.nextTick <= next) {
+      next = b.nextTick;
+      kind = 't';
+    }
+    if (b.adc != NULL && b.nextAdc < next) {
+      next = b.nextAdc;
+      kind = 'a';
+    }
+    if (next > target) {
+      break;
+    }
+    b.now = max(b.now, next);
+    if (kind == 't') {
+      b.nextTick += 1000;
+      b.timer();
+      if (yield && b.busy) {
+        return;
+      }
+    } else if (kind == 'a') {
+      b.nextAdc += b.adcPeriod;
+      b.adc();
+    } else {
+      Event e = b.events.begin()->second;
+      b.events.erase(b.events.begin());
+      apply(e);
+    }
+  }
+  b.now = target;
+}
+
+}  // namespace
+
+HardwareSerial Serial;
+
+/*!
+ * @brief Resets the virtual board (time, pins, serial port and scheduled inputs).
+**/
+void hostReset() {
+  Board &b = board();
+  FILE *out = b.out;
+  void (*sink)(const char *, void *) = b.sink;
+  void *sinkObj = b.sinkObj;
+  b = Board();
+  b.out = out;
+  b.sink = sink;
+  b.sinkObj = sinkObj;
+}
+
+/*!
+ * @brief Shows the time of the virtual board.
+ * @return Time from the reset in [us].
+**/
+uint64_t hostTime() {
+  return board().now;
+}
+
+/*!
+ * @brief Advances the time of the virtual board.
+ * @param us Length to be advanced in [us].
+ * @note Scheduled inputs and the timer interrupt are served
+ *       in time order on the way.
+**/
+void hostAdvance(uint64_t us) {
+  advance(board().now + us, false);
+}
+
+/*!
+ * @brief Sets the time taken by each \c loop call.
+ * @param us Length of a \c loop call in [us].
+**/
+void hostLoopCost(uint32_t us) {
+  board().loopCost = us;
+}
+
+/*!
+ * @brief Lets the time jump while the sketch has nothing to do.
+ * @param us Maximal length of a jump in [us] (\c 0 to disable).
+ * @note When a \c loop call changed nothing observable
+ *       (pins, tones, serial port, or deadlines given by CgnClock),
+ *       the next \c loop cannot behave differently
+ *       until a pending deadline or a scheduled input comes.
+ *       The time then jumps to the earliest of them.
+ *       Hence \c loop calls are aligned to the deadlines and inputs,
+ *       and the results may differ by the length of a \c loop
+ *       from those without jumps.
+ *       Sketches waiting for time by their own (e.g., by comparing
+ *       \c millis or CgnStopwatch) do not tell their deadlines,
+ *       so limit the jump to their tolerable delay.
+ *       No jump is made while A/D conversions run (see \c hostAdc),
+ *       since the sketch has to take the samples in time.
+**/
+void hostFastForward(uint64_t us) {
+  board().jump = us;
+}
+
+/*!
+ * @brief Tells a deadline at which the sketch may change its behavior.
+ * @param len Time to the deadline.
+ * @param micro Whether \a len is in [us] (otherwise in [ms] of \c millis).
+ * @note This is called by CgnClock class for every deadline it makes.
+**/
+void hostDeadline(uint32_t len, bool micro) {
+  Board &b = board();
+  uint64_t t = micro ? b.now + len : (b.now / 1000 + len) * 1000;
+  if (t > b.now) {
+    b.deadlines.insert(t);
+  }
+  b.busy = true;
+}
+
+/*!
+ * @brief Advances the time for a finished \c loop call.
+ * @note Under \c hostFastForward, an idle \c loop call
+ *       is followed by a jump to the next deadline or scheduled input.
+**/
+void hostLoopDone() {
+  Board &b = board();
+  uint64_t to = b.now + b.loopCost;
+  bool due = false;
+  // deadlines passed during the call are yet to be seen by the next one
+  // (they are dropped in every mode so that the set stays small)
+  while (!b.deadlines.empty() && *b.deadlines.begin() <= b.now) {
+    b.deadlines.erase(b.deadlines.begin());
+    due = true;
+  }
+  if (b.jump > 0 && !b.busy && b.adc == NULL && !due) {
+    uint64_t until = b.now + b.jump;
+    if (!b.deadlines.empty()) {
+      until = min(until, *b.deadlines.begin());
+    }
+    if (!b.events.empty()) {
+      until = min(until, b.events.begin()->first);
+    }
+    to = max(to, until);
+  }
+  b.busy = false;
+  advance(to, true);
+}
+
+/*!
+ * @brief Drives a pin from outside of the board.
+ * @param pin Pin number.
+ * @param value \c HIGH or \c LOW (\c -1 to release the pin).
+**/
+void hostSetPin(uint8_t pin, int value) {
+  Board &b = board();
+  if (!valid(pin)) {
+    return;
+  }
+  int from = level(pin);
+  b.drive[pin] = value;
+  b.busy = true;
+  trigger(pin, from, level(pin));
+}
+
+/*!
+ * @brief Shows the level of a pin.
+ * @param pin Pin number.
+ * @return \c HIGH or \c LOW.
+**/
+int hostGetPin(uint8_t pin) {
+  return valid(pin) ? level(pin) : LOW;
+}
+
+/*!
+ * @brief Shows the output value of a pin by \c analogWrite.
+ * @param pin Pin number.
+ * @return Duty of the output (\c 0 to \c 255).
+**/
+int hostGetPwm(uint8_t pin) {
+  return valid(pin) ? board().pwm[pin] : 0;
+}
+
+/*!
+ * @brief Shows the frequency of a tone on a pin.
+ * @param pin Pin number.
+ * @return Frequency in [Hz] (\c 0 when silent).
+**/
+unsigned int hostGetTone(uint8_t pin) {
+  return valid(pin) ? board().freq[pin] : 0;
+}
+
+/*!
+ * @brief Sets the voltage of an analog input.
+ * @param pin Pin number (\c A0 to \c A15, or \c 0 to \c 15).
+ * @param value Value read by \c analogRead (\c 0 to \c 1023).
+**/
+void hostSetAnalog(uint8_t pin, int value) {
+  Board &b = board();
+  if (pin >= A0) {
+    pin -= A0;
+  }
+  if (pin < NUM_ANALOG_INPUTS) {
+    b.analog[pin] = value;
+  }
+}
+
+/*!
+ * @brief Sends a text to the serial port of the board.
+ * @param txt Text to be received by the board.
+**/
+void hostSerialInput(const char *txt) {
+  Board &b = board();
+  while (*txt != '\0') {
+    b.rx.push_back((uint8_t)*txt++);
+  }
+}
+
+/*!
+ * @brief Sets the destination of the serial output from the board.
+ * @param fp Destination (\c NULL to discard).
+**/
+void hostSerialOutput(FILE *fp) {
+  Board &b = board();
+  b.out = fp;
+  b.sink = NULL;
+}
+
+/*!
+ * @brief Passes the serial output from the board line by line to a function.
+ * @param fn Function receiving each line without its line break
+ *        (\c NULL to write to the destination of \c hostSerialOutput again).
+ * @param obj Pointer passed to \a fn as is.
+ * @note A line is passed when the board sends @\n, and @\r is dropped.
+**/
+void hostSerialLines(void (*fn)(const char *, void *), void *obj) {
+  Board &b = board();
+  b.sink = fn;
+  b.sinkObj = obj;
+  b.line.clear();
+}
+
+/*!
+ * @brief Schedules a change of an input pin.
+ * @param us Time of the change from the reset in [us].
+ * @param pin Pin number.
+ * @param value \c HIGH or \c LOW (\c -1 to release the pin).
+**/
+void hostSchedulePin(uint64_t us, uint8_t pin, int value) {
+  schedule(us, 'p', pin, value, NULL);
+}
+
+/*!
+ * @brief Schedules a change of an analog input.
+ * @param us Time of the change from the reset in [us].
+ * @param pin Pin number.
+ * @param value Value read by \c analogRead.
+**/
+void hostScheduleAnalog(uint64_t us, uint8_t pin, int value) {
+  schedule(us, 'a', pin, value, NULL);
+}
+
+/*!
+ * @brief Schedules a text sent to the serial port.
+ * @param us Time of the transmission from the reset in [us].
+ * @param txt Text to be received by the board.
+**/
+void hostScheduleSerial(uint64_t us, const char *txt) {
+  schedule(us, 's', 0, 0, txt);
+}
+
+/*!
+ * @brief Schedules inputs written in a script file (see CgnHost.h).
+ * @param path Path of the script.
+ * @return Whether the whole script was read.
+**/
+bool hostLoadScript(const char *path) {
+  FILE *fp = fopen(path, "r");
+  char line[256];
+  int n = 0;
+  bool ok = true;
+  if (fp == NULL) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return false;
+  }
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    double ms;
+    char kind[16];
+    int pin, value, used;
+    char *p = strchr(line, '#');
+    n++;
+    if (p != NULL) {
+      *p = '\0';
+    }
+    if (sscanf(line, "%lf %15s %n", &ms, kind, &used) < 2) {
+      continue;
+    }
+    uint64_t us = (uint64_t)(ms * 1000 + 0.5);
+    if (strcmp(kind, "serial") == 0) {
+      std::string txt = line + used;
+      while (!txt.empty() && isspace((unsigned char)txt.back())) {
+        txt.pop_back();
+      }
+      hostScheduleSerial(us, (txt + "\n").c_str());
+    } else if (strcmp(kind, "pin") == 0 && sscanf(line + used, "%d %d", &pin, &value) == 2) {
+      hostSchedulePin(us, pin, value);
+    } else if (strcmp(kind, "analog") == 0 && sscanf(line + used, "%d %d", &pin, &value) == 2) {
+      hostScheduleAnalog(us, pin, value);
+    } else {
+      fprintf(stderr, "%s:%d: cannot parse\n", path, n);
+      ok = false;
+    }
+  }
+  fclose(fp);
+  return ok;
+}
+
+/*!
+ * @brief Sets the function called once in every 1 ms (emulating the Timer0 interrupt).
+ * @param isr Function to be called (\c NULL to stop).
+**/
+void hostTimer(void (*isr)()) {
+  Board &b = board();
+  b.timer = isr;
+  b.nextTick = (b.now / 1000 + 1) * 1000;
+}
+
+/*!
+ * @brief Sets the function called at every completion of an A/D conversion
+ *        (emulating the ADC interrupt under auto triggering).
+ * @param isr Function to be called (\c NULL to stop).
+ * @param us Interval of the conversions in [us].
+**/
+void hostAdc(void (*isr)(), uint32_t us) {
+  Board &b = board();
+  b.adc = (us > 0) ? isr : NULL;
+  b.adcPeriod = us;
+  b.nextAdc = b.now + us;
+}
+
+uint32_t millis() {
+  return (uint32_t)(board().now / 1000);
+}
+
+uint32_t micros() {
+  return (uint32_t)board().now;
+}
+
+void delay(uint32_t ms) {
+  hostAdvance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostAdvance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  Board &b = board();
+  if (!valid(pin)) {
+    return;
+  }
+  int from = level(pin);
+  b.busy = b.busy || b.mode[pin] != mode;
+  b.mode[pin] = mode;
+  if (mode == INPUT_PULLUP) {
+    b.latch[pin] = HIGH;
+  } else if (mode == INPUT) {
+    b.latch[pin] = LOW;
+  }
+  trigger(pin, from, level(pin));
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  Board &b = board();
+  if (!valid(pin)) {
+    return;
+  }
+  int from = level(pin);
+  int duty = value ? 255 : 0;
+  b.busy = b.busy || b.pwm[pin] != duty;
+  b.latch[pin] = value ? HIGH : LOW;
+  b.pwm[pin] = duty;
+  if (b.mode[pin] != OUTPUT) {
+    // writing to an input switches its pull-up as on AVR
+    b.mode[pin] = value ? INPUT_PULLUP : INPUT;
+  }
+  trigger(pin, from, level(pin));
+}
+
+int digitalRead(uint8_t pin) {
+  return valid(pin) ? level(pin) : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  Board &b = board();
+  if (pin >= A0) {
+    pin -= A0;
+  }
+  return (pin < NUM_ANALOG_INPUTS) ? b.analog[pin] : 0;
+}
+
+void analogWrite(uint8_t pin, int value) {
+  Board &b = board();
+  if (!valid(pin)) {
+    return;
+  }
+  int from = level(pin);
+  int duty = constrain(value, 0, 255);
+  b.busy = b.busy || b.pwm[pin] != duty || b.mode[pin] != OUTPUT;
+  b.mode[pin] = OUTPUT;
+  b.pwm[pin] = duty;
+  b.latch[pin] = (b.pwm[pin] >= 128) ? HIGH : LOW;
+  trigger(pin, from, level(pin));
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+  Board &b = board();
+  if (!valid(pin)) {
+    return;
+  }
+  b.freq[pin] = frequency;
+  b.toneId[pin]++;
+  b.busy = true;
+  if (duration > 0) {
+    schedule(b.now + (uint64_t)duration * 1000, 't', pin, b.toneId[pin], NULL);
+  }
+}
+
+void noTone(uint8_t pin) {
+  Board &b = board();
+  if (!valid(pin)) {
+    return;
+  }
+  b.freq[pin] = 0;
+  b.toneId[pin]++;
+  b.busy = true;
+}
+
+int digitalPinToInterrupt(uint8_t pin) {
+  for (int k = 0; k < N_IRQ; k++) {
+    if (IRQ_PIN[k] == pin) {
+      return k;
+    }
+  }
+  return NOT_AN_INTERRUPT;
+}
+
+void attachInterrupt(uint8_t irq, void (*isr)(), int mode) {
+  Board &b = board();
+  if (irq < N_IRQ) {
+    b.isr[irq] = isr;
+    b.isrMode[irq] = mode;
+  }
+}
+
+void detachInterrupt(uint8_t irq) {
+  Board &b = board();
+  if (irq < N_IRQ) {
+    b.isr[irq] = NULL;
+  }
+}
+
+long random(long howbig) {
+  Board &b = board();
+  if (howbig <= 0) {
+    return 0;
+  }
+  // xorshift32, so that runs are reproducible on any host
+  b.seed ^= b.seed << 13;
+  b.seed ^= b.seed >> 17;
+  b.seed ^= b.seed << 5;
+  return b.seed % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) {
+    return howsmall;
+  }
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+  Board &b = board();
+  if (seed != 0) {
+    b.seed = (uint32_t)seed;
+  }
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+int HardwareSerial::available() {
+  return (int)board().rx.size();
+}
+
+int HardwareSerial::read() {
+  Board &b = board();
+  if (b.rx.empty()) {
+    return -1;
+  }
+  int c = b.rx.front();
+  b.rx.pop_front();
+  b.busy = true;
+  return c;
+}
+
+int HardwareSerial::peek() {
+  return board().rx.empty() ? -1 : board().rx.front();
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  Board &b = board();
+  b.busy = true;
+  if (b.sink != NULL) {
+    if (c == '\n') {
+      b.sink(b.line.c_str(), b.sinkObj);
+      b.line.clear();
+    } else if (c != '\r') {
+      b.line += (char)c;
+    }
+  } else if (b.out != NULL) {
+    fputc(c, b.out);
+  }
+  return 1;
+}
@@ -0,0 +1,310 @@
+/*!
+ * @file Arduino.h
+ * @brief Emulated Arduino core for building cgnuino on a host computer.
+ * @author Kei Mochizuki
+ *
+ * This header stands in for the Arduino core when cgnuino library
+ * and its example sketches are compiled natively (e.g., on Linux)
+ * by the CMake project at the top of the repository.
+ * Only the part of the Arduino API used by cgnuino is provided.
+ * Time, pins and the serial port belong to a virtual board
+ * controlled by the functions declared in CgnHost.h.
+ * The board is modeled after Arduino Mega 2560
+ * (70 digital pins, 16 analog inputs starting at pin 54).
+**/
+
+#ifndef INCLUDED_ARDUINO_HOST
+#define INCLUDED_ARDUINO_HOST
+
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <string>
+
+// cgnuino defines its own ULONG_MAX as a 32-bit constant
+#undef ULONG_MAX
+
+/*!
+ * @def CGN_HOST
+ * @brief Defined when cgnuino is compiled against the emulated core.
+**/
+#define CGN_HOST 1
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define F_CPU 16000000UL
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+#define clockCyclesToMicroseconds(a) ((a) / clockCyclesPerMicrosecond())
+#define microsecondsToClockCycles(a) ((a) * clockCyclesPerMicrosecond())
+
+#define NUM_DIGITAL_PINS 70
+#define NUM_ANALOG_INPUTS 16
+#define NOT_AN_INTERRUPT -1
+#define LED_BUILTIN 13
+
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define A5 59
+#define A6 60
+#define A7 61
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+#define PI 3.1415926535897932384626433832795
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define _BV(bit) (1 << (bit))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define sq(x) ((x) * (x))
+
+template <class T, class L>
+auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (b < a) ? b : a;
+}
+
+template <class T, class L>
+auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (a < b) ? b : a;
+}
+
+// program memory is ordinary memory on the host
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_float(addr) (*(const float *)(addr))
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+
+// interrupts of the virtual board are only served between sketch statements
+#define interrupts()
+#define noInterrupts()
+#define cli()
+#define sei()
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t);
+void delayMicroseconds(unsigned int);
+
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+int analogRead(uint8_t);
+void analogWrite(uint8_t, int);
+void tone(uint8_t, unsigned int, unsigned long = 0);
+void noTone(uint8_t);
+
+int digitalPinToInterrupt(uint8_t);
+void attachInterrupt(uint8_t, void (*)(), int);
+void detachInterrupt(uint8_t);
+
+long random(long);
+long random(long, long);
+void randomSeed(unsigned long);
+long map(long, long, long, long, long);
+
+/*!
+ * @brief Text container compatible with Arduino's String.
+**/
+class String {
+  public:
+    String(const char * = "");
+    String(const String &);
+    String(const __FlashStringHelper *);
+    explicit String(char);
+    explicit String(unsigned char, unsigned char = 10);
+    explicit String(int, unsigned char = 10);
+    explicit String(unsigned int, unsigned char = 10);
+    explicit String(long, unsigned char = 10);
+    explicit String(unsigned long, unsigned char = 10);
+    explicit String(float, unsigned char = 2);
+    explicit String(double, unsigned char = 2);
+
+    String &operator=(const String &);
+    String &operator=(const char *);
+    bool reserve(unsigned int);
+    unsigned int length() const;
+    const char *c_str() const;
+
+    bool concat(const String &);
+    bool concat(const char *);
+    bool concat(char);
+    bool concat(unsigned char);
+    bool concat(int);
+    bool concat(unsigned int);
+    bool concat(long);
+    bool concat(unsigned long);
+    bool concat(float);
+    bool concat(double);
+    bool concat(const __FlashStringHelper *);
+    template <class T> String &operator+=(const T &x) {
+      concat(x);
+      return *this;
+    }
+
+    bool equals(const String &) const;
+    bool equals(const char *) const;
+    bool equalsIgnoreCase(const String &) const;
+    bool operator==(const String &s) const { return equals(s); }
+    bool operator==(const char *s) const { return equals(s); }
+    bool operator!=(const String &s) const { return !equals(s); }
+    bool operator!=(const char *s) const { return !equals(s); }
+    bool operator<(const String &s) const { return s_ < s.s_; }
+    bool startsWith(const String &) const;
+    bool endsWith(const String &) const;
+
+    char charAt(unsigned int) const;
+    void setCharAt(unsigned int, char);
+    char operator[](unsigned int) const;
+    char &operator[](unsigned int);
+    int indexOf(char, unsigned int = 0) const;
+    int indexOf(const String &, unsigned int = 0) const;
+    int lastIndexOf(char) const;
+    int lastIndexOf(const String &) const;
+    String substring(unsigned int) const;
+    String substring(unsigned int, unsigned int) const;
+
+    void replace(char, char);
+    void replace(const String &, const String &);
+    void remove(unsigned int);
+    void remove(unsigned int, unsigned int);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+  private:
+    std::string s_;
+};
+
+template <class T> String operator+(const String &a, const T &b) {
+  String s = a;
+  s.concat(b);
+  return s;
+}
+
+/*!
+ * @brief Base class of text output compatible with Arduino's Print.
+**/
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *, size_t);
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t write(const char *s, size_t n) { return write((const uint8_t *)s, n); }
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *);
+    size_t print(const String &);
+    size_t print(const char *);
+    size_t print(char);
+    size_t print(unsigned char, int = DEC);
+    size_t print(int, int = DEC);
+    size_t print(unsigned int, int = DEC);
+    size_t print(long, int = DEC);
+    size_t print(unsigned long, int = DEC);
+    size_t print(long long, int = DEC);
+    size_t print(unsigned long long, int = DEC);
+    size_t print(double, int = 2);
+
+    size_t println();
+    template <class T> size_t println(const T &x) {
+      size_t n = print(x);
+      return n + println();
+    }
+    template <class T> size_t println(const T &x, int f) {
+      size_t n = print(x, f);
+      return n + println();
+    }
+
+  private:
+    size_t printNumber(unsigned long long, uint8_t);
+    size_t printFloat(double, uint8_t);
+};
+
+/*!
+ * @brief Base class of text input compatible with Arduino's Stream.
+**/
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long ms) { timeout = ms; }
+    String readString();
+    String readStringUntil(char);
+
+  protected:
+    int timedRead();
+    unsigned long timeout = 1000;
+};
+
+/*!
+ * @brief Serial port of the virtual board.
+**/
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long, uint8_t = 0) {}
+    void end() {}
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override;
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#include "CgnHost.h"
+
+#endif
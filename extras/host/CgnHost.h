@@ -0,0 +1,70 @@
+/*!
+ * @file CgnHost.h
+ * @brief Control of the virtual board behind the emulated Arduino core.
+ * @author Kei Mochizuki
+ *
+ * A host build of cgnuino runs a sketch on a virtual board
+ * whose time advances only when the sketch waits
+ * (\c delay, \c delayMicroseconds) or when a \c loop call finishes.
+ * The functions below let a test driver (or \c main of the host build)
+ * move the time, drive the inputs and watch the outputs,
+ * so that timing behavior can be examined deterministically.
+ *
+ * With \c hostFastForward, the board also skips the time
+ * in which the sketch has nothing to do:
+ * when a \c loop call changed nothing observable,
+ * the time jumps to the next deadline made by CgnClock class
+ * (i.e., the time limits of CgnDO, CgnAO, CgnTone, CgnTimerDO, CgnTimerAO,
+ * CgnPeriod, CgnState, etc.) or the next scheduled input.
+ * A session of hours then runs in seconds.
+ *
+ * External inputs can also be given as a script,
+ * each line of which is one of the below
+ * (time in [ms] from the reset of the board, \c # for comments).
+ *
+ * \code
+ * 1500 pin 2 0         # drive pin 2 LOW at 1.5 s
+ * 1620 pin 2 1         # and HIGH at 1.62 s
+ * 2000 analog 54 512   # set analog input A0
+ * 3000 serial X123     # send "X123\n" to the serial port
+ * \endcode
+ *
+ * The board is kept for each thread.
+ * A thread started by a test driver thus begins with a fresh board
+ * as well as fresh cgnuino internals (CgnClock, CgnScheduler, etc.; see \c CGN_LOCAL),
+ * and many sessions can run in parallel (see extras/montecarlo).
+**/
+
+#ifndef INCLUDED_CGNHOST
+#define INCLUDED_CGNHOST
+
+#include <stdint.h>
+#include <stdio.h>
+
+void hostReset();
+uint64_t hostTime();
+void hostAdvance(uint64_t);
+void hostLoopCost(uint32_t);
+void hostLoopDone();
+void hostFastForward(uint64_t);
+void hostDeadline(uint32_t, bool);
+
+void hostSetPin(uint8_t, int);
+int hostGetPin(uint8_t);
+int hostGetPwm(uint8_t);
+unsigned int hostGetTone(uint8_t);
+void hostSetAnalog(uint8_t, int);
+
+void hostSerialInput(const char *);
+void hostSerialOutput(FILE *);
+void hostSerialLines(void (*)(const char *, void *), void *);
+
+void hostSchedulePin(uint64_t, uint8_t, int);
+void hostScheduleAnalog(uint64_t, uint8_t, int);
+void hostScheduleSerial(uint64_t, const char *);
+bool hostLoadScript(const char *);
+
+void hostTimer(void (*)());
+void hostAdc(void (*)(), uint32_t);
+
+#endif
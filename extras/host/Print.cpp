@@ -0,0 +1,160 @@
+/*!
+ * @file Print.cpp
+ * @brief Print and Stream classes of the emulated Arduino core.
+ * @author Kei Mochizuki
+**/
+
+#include "Arduino.h"
+
+size_t Print::write(const uint8_t *buf, size_t n) {
+  size_t k = 0;
+  while (n-- > 0) {
+    k += write(*buf++);
+  }
+  return k;
+}
+
+size_t Print::print(const __FlashStringHelper *s) {
+  return print((const char *)s);
+}
+
+size_t Print::print(const String &s) {
+  return write(s.c_str(), s.length());
+}
+
+size_t Print::print(const char *s) {
+  return write(s);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char v, int base) {
+  return print((unsigned long long)v, base);
+}
+
+size_t Print::print(int v, int base) {
+  return print((long long)v, base);
+}
+
+size_t Print::print(unsigned int v, int base) {
+  return print((unsigned long long)v, base);
+}
+
+size_t Print::print(long v, int base) {
+  return print((long long)v, base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  return print((unsigned long long)v, base);
+}
+
+size_t Print::print(long long v, int base) {
+  if (base == 0) {
+    return write((uint8_t)v);
+  }
+  if (base == 10 && v < 0) {
+    size_t n = print('-');
+    return n + printNumber(-(unsigned long long)v, 10);
+  }
+  return printNumber((unsigned long long)v, base);
+}
+
+size_t Print::print(unsigned long long v, int base) {
+  if (base == 0) {
+    return write((uint8_t)v);
+  }
+  return printNumber(v, base);
+}
+
+size_t Print::print(double v, int digits) {
+  return printFloat(v, digits);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::printNumber(unsigned long long v, uint8_t base) {
+  char buf[8 * sizeof(v) + 1];
+  char *p = &buf[sizeof(buf) - 1];
+  *p = '\0';
+  if (base < 2) {
+    base = 10;
+  }
+  do {
+    int d = v % base;
+    *--p = (d < 10) ? '0' + d : 'A' + d - 10;
+    v /= base;
+  } while (v > 0);
+  return write(p);
+}
+
+size_t Print::printFloat(double v, uint8_t digits) {
+  size_t n = 0;
+  double rounding = 0.5;
+  unsigned long long whole;
+  double rest;
+
+  // same output as Arduino's Print including its limits
+  if (isnan(v)) {
+    return print("nan");
+  }
+  if (isinf(v)) {
+    return print("inf");
+  }
+  if (v > 4294967040.0 || v < -4294967040.0) {
+    return print("ovf");
+  }
+  if (v < 0.0) {
+    n += print('-');
+    v = -v;
+  }
+  for (uint8_t i = 0; i < digits; i++) {
+    rounding /= 10.0;
+  }
+  v += rounding;
+  whole = (unsigned long long)v;
+  rest = v - (double)whole;
+  n += printNumber(whole, 10);
+  if (digits > 0) {
+    n += print('.');
+  }
+  while (digits-- > 0) {
+    rest *= 10.0;
+    unsigned int d = (unsigned int)rest;
+    n += print(d);
+    rest -= d;
+  }
+  return n;
+}
+
+int Stream::timedRead() {
+  // waits in virtual time so that scheduled inputs can arrive
+  for (unsigned long t = 0; t <= timeout; t++) {
+    if (available() > 0) {
+      return read();
+    }
+    delay(1);
+  }
+  return -1;
+}
+
+String Stream::readString() {
+  String s;
+  int c;
+  while ((c = timedRead()) >= 0) {
+    s += (char)c;
+  }
+  return s;
+}
+
+String Stream::readStringUntil(char term) {
+  String s;
+  int c;
+  while ((c = timedRead()) >= 0 && c != term) {
+    s += (char)c;
+  }
+  return s;
+}
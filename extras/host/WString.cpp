@@ -0,0 +1,288 @@
+/*!
+ * @file WString.cpp
+ * @brief String class of the emulated Arduino core.
+ * @author Kei Mochizuki
+**/
+
+#include "Arduino.h"
+
+namespace {
+
+std::string number(unsigned long long v, unsigned char base, bool neg) {
+  std::string s;
+  if (base < 2) {
+    base = 10;
+  }
+  do {
+    int d = v % base;
+    s.insert(s.begin(), (char)(d < 10 ? '0' + d : 'A' + d - 10));
+    v /= base;
+  } while (v > 0);
+  if (neg) {
+    s.insert(s.begin(), '-');
+  }
+  return s;
+}
+
+std::string signedNumber(long long v, unsigned char base) {
+  if (base == 10 && v < 0) {
+    return number(-(unsigned long long)v, base, true);
+  }
+  // other bases print the two's complement as Arduino does
+  return number((unsigned long)v, base, false);
+}
+
+std::string decimal(double v, unsigned char digits) {
+  char buf[64];
+  if (isnan(v)) {
+    return "nan";
+  }
+  if (isinf(v)) {
+    return "inf";
+  }
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return buf;
+}
+
+}  // namespace
+
+String::String(const char *s) : s_(s == NULL ? "" : s) {}
+String::String(const String &s) : s_(s.s_) {}
+String::String(const __FlashStringHelper *s) : String((const char *)s) {}
+String::String(char c) : s_(1, c) {}
+String::String(unsigned char v, unsigned char base) : s_(number(v, base, false)) {}
+String::String(int v, unsigned char base) : s_(signedNumber(v, base)) {}
+String::String(unsigned int v, unsigned char base) : s_(number(v, base, false)) {}
+String::String(long v, unsigned char base) : s_(signedNumber(v, base)) {}
+String::String(unsigned long v, unsigned char base) : s_(number(v, base, false)) {}
+String::String(float v, unsigned char digits) : s_(decimal(v, digits)) {}
+String::String(double v, unsigned char digits) : s_(decimal(v, digits)) {}
+
+String &String::operator=(const String &s) {
+  s_ = s.s_;
+  return *this;
+}
+
+String &String::operator=(const char *s) {
+  s_ = (s == NULL) ? "" : s;
+  return *this;
+}
+
+bool String::reserve(unsigned int n) {
+  s_.reserve(n);
+  return true;
+}
+
+unsigned int String::length() const {
+  return s_.size();
+}
+
+const char *String::c_str() const {
+  return s_.c_str();
+}
+
+bool String::concat(const String &s) {
+  s_ += s.s_;
+  return true;
+}
+
+bool String::concat(const char *s) {
+  if (s == NULL) {
+    return false;
+  }
+  s_ += s;
+  return true;
+}
+
+bool String::concat(char c) {
+  s_ += c;
+  return true;
+}
+
+bool String::concat(unsigned char v) {
+  return concat(String(v));
+}
+
+bool String::concat(int v) {
+  return concat(String(v));
+}
+
+bool String::concat(unsigned int v) {
+  return concat(String(v));
+}
+
+bool String::concat(long v) {
+  return concat(String(v));
+}
+
+bool String::concat(unsigned long v) {
+  return concat(String(v));
+}
+
+bool String::concat(float v) {
+  return concat(String(v));
+}
+
+bool String::concat(double v) {
+  return concat(String(v));
+}
+
+bool String::concat(const __FlashStringHelper *s) {
+  return concat((const char *)s);
+}
+
+bool String::equals(const String &s) const {
+  return s_ == s.s_;
+}
+
+bool String::equals(const char *s) const {
+  return s_ == (s == NULL ? "" : s);
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+  if (s_.size() != s.s_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < s_.size(); i++) {
+    if (tolower((unsigned char)s_[i]) != tolower((unsigned char)s.s_[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool String::startsWith(const String &s) const {
+  return s_.compare(0, s.s_.size(), s.s_) == 0 && s_.size() >= s.s_.size();
+}
+
+bool String::endsWith(const String &s) const {
+  return s_.size() >= s.s_.size() &&
+         s_.compare(s_.size() - s.s_.size(), s.s_.size(), s.s_) == 0;
+}
+
+char String::charAt(unsigned int i) const {
+  return (i < s_.size()) ? s_[i] : 0;
+}
+
+void String::setCharAt(unsigned int i, char c) {
+  if (i < s_.size()) {
+    s_[i] = c;
+  }
+}
+
+char String::operator[](unsigned int i) const {
+  return charAt(i);
+}
+
+char &String::operator[](unsigned int i) {
+  static char dummy;
+  if (i >= s_.size()) {
+    dummy = 0;
+    return dummy;
+  }
+  return s_[i];
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t i = s_.find(c, from);
+  return (i == std::string::npos) ? -1 : (int)i;
+}
+
+int String::indexOf(const String &s, unsigned int from) const {
+  size_t i = s_.find(s.s_, from);
+  return (i == std::string::npos) ? -1 : (int)i;
+}
+
+int String::lastIndexOf(char c) const {
+  size_t i = s_.rfind(c);
+  return (i == std::string::npos) ? -1 : (int)i;
+}
+
+int String::lastIndexOf(const String &s) const {
+  size_t i = s_.rfind(s.s_);
+  return (i == std::string::npos) ? -1 : (int)i;
+}
+
+String String::substring(unsigned int from) const {
+  return substring(from, s_.size());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    unsigned int t = from;
+    from = to;
+    to = t;
+  }
+  if (from >= s_.size()) {
+    return String();
+  }
+  to = min(to, (unsigned int)s_.size());
+  return String(s_.substr(from, to - from).c_str());
+}
+
+void String::replace(char a, char b) {
+  for (size_t i = 0; i < s_.size(); i++) {
+    if (s_[i] == a) {
+      s_[i] = b;
+    }
+  }
+}
+
+void String::replace(const String &a, const String &b) {
+  size_t i = 0;
+  if (a.s_.empty()) {
+    return;
+  }
+  while ((i = s_.find(a.s_, i)) != std::string::npos) {
+    s_.replace(i, a.s_.size(), b.s_);
+    i += b.s_.size();
+  }
+}
+
+void String::remove(unsigned int from) {
+  if (from < s_.size()) {
+    s_.erase(from);
+  }
+}
+
+void String::remove(unsigned int from, unsigned int n) {
+  if (from < s_.size()) {
+    s_.erase(from, n);
+  }
+}
+
+void String::toLowerCase() {
+  for (size_t i = 0; i < s_.size(); i++) {
+    s_[i] = tolower((unsigned char)s_[i]);
+  }
+}
+
+void String::toUpperCase() {
+  for (size_t i = 0; i < s_.size(); i++) {
+    s_[i] = toupper((unsigned char)s_[i]);
+  }
+}
+
+void String::trim() {
+  size_t a = 0;
+  size_t b = s_.size();
+  while (a < b && isspace((unsigned char)s_[a])) {
+    a++;
+  }
+  while (b > a && isspace((unsigned char)s_[b - 1])) {
+    b--;
+  }
+  s_ = s_.substr(a, b - a);
+}
+
+long String::toInt() const {
+  return atol(s_.c_str());
+}
+
+float String::toFloat() const {
+  return (float)atof(s_.c_str());
+}
+
+double String::toDouble() const {
+  return atof(s_.c_str());
+}
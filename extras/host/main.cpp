@@ -0,0 +1,75 @@
+/*!
+ * @file main.cpp
+ * @brief Runs an Arduino sketch on the virtual board for a limited time.
+ * @author Kei Mochizuki
+ *
+ * Each example sketch of cgnuino is built into a host executable
+ * with this \c main, which calls \c setup once and \c loop repeatedly
+ * until the virtual time reaches the designated length.
+ * The serial output of the board is written to the standard output.
+ *
+ * \code
+ * ./DI -t 5 -s presses.txt     # 5 s with inputs scheduled by a script
+ * ./Lchika -t 60 -l 50         # 60 s assuming 50 us per loop
+ * ./Machine -t 7200 -f         # 2 h, skipping idle time
+ * ./Scheduler -t 600 -j 10     # skipping at most 10 ms at once
+ * \endcode
+**/
+
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [-t seconds] [-l loop_us] [-s script] [-f] [-j max_ms] [-q]\n"
+          "  -t  length of the run in virtual time (default 10 s)\n"
+          "  -l  time taken by each loop call (default 10 us)\n"
+          "  -s  script of inputs (see CgnHost.h)\n"
+          "  -f  jump over idle time to the next deadline or input\n"
+          "  -j  same as -f but jumping at most max_ms at once\n"
+          "  -q  discard the serial output\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  double sec = 10;
+  double jump = -1;
+  uint64_t limit;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      sec = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      hostLoopCost(strtoul(argv[++i], NULL, 10));
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      if (!hostLoadScript(argv[++i])) {
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-f") == 0) {
+      jump = 0;
+    } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      jump = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-q") == 0) {
+      hostSerialOutput(NULL);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  limit = (uint64_t)(sec * 1e6);
+  if (jump == 0) {
+    hostFastForward(limit);
+  } else if (jump > 0) {
+    hostFastForward((uint64_t)(jump * 1e3));
+  }
+  setup();
+  while (hostTime() < limit) {
+    loop();
+    hostLoopDone();
+  }
+  fflush(stdout);
+  return 0;
+}
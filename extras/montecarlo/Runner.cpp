@@ -0,0 +1,166 @@
+/*!
+ * @file Runner.cpp
+ * @brief Definition of Runner class.
+ * @author Kei Mochizuki
+**/
+
+#include "Runner.h"
+
+#include <thread>
+
+#include "Arduino.h"
+
+constexpr size_t N_RUNNERBUF = 16384; //!< Bytes of output kept by a session before written out.
+
+/*!
+ * @brief Constructor.
+ * @param threadCount Number of sessions run at once
+ *        (\c 0 for the number of cores of the host).
+**/
+Runner::Runner(unsigned threadCount) {
+  nThread = threadCount;
+  if (nThread == 0) {
+    nThread = std::thread::hardware_concurrency();
+  }
+  if (nThread == 0) {
+    nThread = 1;
+  }
+  out = stdout;
+  rows = 0;
+}
+
+/*!
+ * @brief Runs sessions to the end.
+ * @param sessions Number of sessions.
+ * @param sessionBody Function running a session of a given number
+ *        (from \c 0 to \a sessions - 1) on the calling thread's board.
+ * @param fp Destination of the merged serial output (\c NULL to discard).
+ * @return Number of lines written out.
+**/
+uint64_t Runner::run(unsigned sessions, std::function<void(unsigned)> sessionBody, FILE *fp) {
+  std::vector<std::thread> workers;
+  unsigned n = nThread;
+
+  body = sessionBody;
+  out = fp;
+  rows = 0;
+  queues = std::vector<Queue>(n);
+  for (unsigned w = 0; w < n; w++) {
+    for (unsigned id = sessions * w / n; id < sessions * (w + 1) / n; id++) {
+      queues[w].ids.push_back(id);
+    }
+  }
+
+  for (unsigned w = 0; w < n; w++) {
+    workers.push_back(std::thread(&Runner::work, this, w));
+  }
+  for (unsigned w = 0; w < n; w++) {
+    workers[w].join();
+  }
+  if (out != NULL) {
+    fflush(out);
+  }
+  return rows;
+}
+
+/*!
+ * @brief Shows the number of sessions run at once.
+ * @return Number of workers.
+**/
+unsigned Runner::threads() {
+  return nThread;
+}
+
+/*!
+ * @brief Receives a serial line of a session (passed to \c hostSerialLines).
+ * @param line Line without its line break.
+ * @param obj Session sending the line.
+ * @note Rows of CgnData begin with the separator already,
+ *       so no tab is added after the session number then.
+**/
+void Runner::collect(const char *line, void *obj) {
+  Session &s = *(Session *)obj;
+  s.buf += std::to_string(s.id);
+  if (line[0] != '\t') {
+    s.buf += '\t';
+  }
+  s.buf += line;
+  s.buf += '\n';
+  s.rows++;
+  if (s.buf.size() >= N_RUNNERBUF) {
+    s.runner->flush(s);
+  }
+}
+
+/*!
+ * @brief Takes the next session for a worker.
+ * @param w Index of the worker.
+ * @param id Taken session number.
+ * @return Whether any session was left.
+ * @note A worker takes from the head of its own queue,
+ *       and steals from the tail of the others when it has none.
+ *       No session is added during a run,
+ *       so a worker finding all the queues empty may finish.
+**/
+bool Runner::take(unsigned w, unsigned &id) {
+  unsigned n = (unsigned)queues.size();
+  for (unsigned k = 0; k < n; k++) {
+    Queue &q = queues[(w + k) % n];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.ids.empty()) {
+      continue;
+    }
+    if (k == 0) {
+      id = q.ids.front();
+      q.ids.pop_front();
+    } else {
+      id = q.ids.back();
+      q.ids.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+/*!
+ * @brief Runs sessions on a worker until none is left.
+ * @param w Index of the worker.
+**/
+void Runner::work(unsigned w) {
+  unsigned id;
+  while (take(w, id)) {
+    // a new thread starts with a new board and new cgnuino internals,
+    // while a reused one would carry the clock and hooks of the last session
+    std::thread t(&Runner::session, this, id);
+    t.join();
+  }
+}
+
+/*!
+ * @brief Runs a session on the calling thread.
+ * @param id Session number.
+**/
+void Runner::session(unsigned id) {
+  Session s;
+  s.runner = this;
+  s.id = id;
+  s.rows = 0;
+  hostSerialLines(collect, &s);
+  body(id);
+  hostSerialLines(NULL, NULL);
+  flush(s);
+}
+
+/*!
+ * @brief Writes the buffered lines of a session out.
+ * @param s Session.
+**/
+void Runner::flush(Session &s) {
+  std::lock_guard<std::mutex> guard(outLock);
+  if (out != NULL) {
+    fwrite(s.buf.data(), 1, s.buf.size(), out);
+  }
+  rows += s.rows;
+  s.buf.clear();
+  s.rows = 0;
+}
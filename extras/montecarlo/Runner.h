@@ -0,0 +1,78 @@
+/*!
+ * @file Runner.h
+ * @brief Runs many simulated sessions in parallel on independent virtual boards.
+ * @author Kei Mochizuki
+ *
+ * Runner class is the core of the Monte Carlo simulation of behavioral tasks.
+ * Each session runs on a thread of its own, and thus on a fresh virtual board
+ * with its own clock, pins and serial port (see CgnHost.h),
+ * as well as fresh internals of cgnuino (see \c CGN_LOCAL).
+ * A session body therefore constructs its Cgn* objects locally
+ * (not as globals as in sketches) and runs them to the end.
+ *
+ * Sessions are dealt to a pool of workers in contiguous blocks.
+ * A worker that finished its own block steals sessions
+ * from the tail of the others, so that long and short sessions
+ * are balanced without any central queue.
+ *
+ * Lines sent to the serial port (e.g., rows of CgnData)
+ * are prefixed with the session number and a tab,
+ * and streamed into a single output in chunks of whole lines.
+ * Lines of a session keep their order,
+ * while those of different sessions are interleaved.
+ *
+ * \code
+ * Runner runner(8);
+ * runner.run(1000, [](unsigned id) {
+ *   Task task = Task(id);
+ *   while (!task.done()) {
+ *     task.loop();
+ *     hostLoopDone();
+ *   }
+ * });
+ * \endcode
+**/
+
+#ifndef INCLUDED_CGNRUNNER
+#define INCLUDED_CGNRUNNER
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Runner {
+  public:
+    Runner(unsigned = 0);
+    uint64_t run(unsigned, std::function<void(unsigned)>, FILE * = stdout);
+    unsigned threads();
+
+  private:
+    struct Queue {
+      std::mutex lock;
+      std::deque<unsigned> ids;
+    };
+    struct Session {
+      Runner *runner;
+      unsigned id;
+      std::string buf;
+      uint64_t rows;
+    };
+    static void collect(const char *, void *);
+    bool take(unsigned, unsigned &);
+    void work(unsigned);
+    void session(unsigned);
+    void flush(Session &);
+    unsigned nThread;
+    std::vector<Queue> queues;
+    std::function<void(unsigned)> body;
+    FILE *out;
+    std::mutex outLock;
+    uint64_t rows;
+};
+
+#endif
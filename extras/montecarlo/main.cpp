@@ -0,0 +1,200 @@
+/*!
+ * @file main.cpp
+ * @brief Monte Carlo simulation of a detection task with virtual subjects.
+ * @author Kei Mochizuki
+ *
+ * Each session runs a simple detection task written with cgnuino:
+ * a visual stimulus of a random intensity (PWM duty of pin 9 by CgnAO)
+ * is presented for 500 ms after a random inter-trial interval,
+ * and a lever press (pin 2 by CgnDI) within 1 s from its onset
+ * is rewarded (pin 13 by CgnDO).
+ * Every trial is written by CgnData as a row of
+ * trial number, intensity, response and reaction time.
+ *
+ * A virtual subject watches the stimulus pin of the board,
+ * and presses the lever with a probability
+ * following a logistic function of the intensity.
+ * The threshold differs among subjects (i.e., sessions),
+ * and the subject also guesses and lapses at small rates.
+ *
+ * \code
+ * ./montecarlo -n 1000 > trials.tsv      # 1000 sessions on all the cores
+ * ./montecarlo -n 200 -p 1 -q            # single thread, just timing
+ * \endcode
+**/
+
+#include <math.h>
+
+#include <chrono>
+#include <random>
+
+#include "Arduino.h"
+#include "cgnuino.h"
+#include "Runner.h"
+
+constexpr byte LEVER = 2;
+constexpr byte STIM = 9;
+constexpr byte REWARD = 13;
+constexpr byte LEVELS[] = {16, 48, 80, 112, 144, 192};
+
+/*!
+ * @brief Detection task run by a session (a sketch whose globals became members).
+**/
+class Task {
+  public:
+    Task(unsigned, uint32_t);
+    void loop();
+    bool done();
+
+  private:
+    enum {ITI, WINDOW};
+    void finish(bool);
+    CgnDI lever;
+    CgnAO stim;
+    CgnDO reward;
+    CgnState state;
+    CgnData data;
+    uint32_t nTrial;
+    uint32_t trial;
+    byte level;
+};
+
+Task::Task(unsigned trials, uint32_t seed)
+    : lever(LEVER), stim(STIM), reward(REWARD), state(F("iti\twindow")) {
+  randomSeed(seed);
+  nTrial = trials;
+  trial = 0;
+  level = 0;
+  state.set(ITI, random(1000, 2000));
+}
+
+void Task::loop() {
+  lever.update();
+  stim.update();
+  reward.update();
+
+  if (state.is(ITI) && state.expire() && !done()) {
+    level = LEVELS[random(countof(LEVELS))];
+    stim.out(500, level);
+    state.set(WINDOW, 1000);
+
+  } else if (state.is(WINDOW) && lever.turnon()) {
+    reward.out(0, 100);
+    finish(true);
+
+  } else if (state.is(WINDOW) && state.expire()) {
+    finish(false);
+  }
+}
+
+bool Task::done() {
+  return trial >= nTrial;
+}
+
+void Task::finish(bool hit) {
+  trial++;
+  data.append(String(trial));
+  data.append(String(level));
+  data.append(String(hit ? 1 : 0));
+  data.append(String(hit ? cgnClock.now() - state.since() : 0));
+  data.out();
+  state.set(ITI, random(1000, 2000));
+}
+
+/*!
+ * @brief Virtual subject pressing the lever in response to the stimulus.
+**/
+class Subject {
+  public:
+    Subject(uint32_t);
+    void watch();
+
+  private:
+    std::mt19937 rng;
+    double threshold;
+    int last;
+};
+
+Subject::Subject(uint32_t seed) : rng(seed) {
+  std::normal_distribution<double> spread(96.0, 16.0);
+  threshold = spread(rng);
+  last = 0;
+}
+
+void Subject::watch() {
+  int duty = hostGetPwm(STIM);
+  if (duty > 0 && last == 0) {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::exponential_distribution<double> decision(1.0 / 150.0);
+    double p = 1.0 / (1.0 + exp(-(duty - threshold) / 12.0));
+    p = 0.05 + 0.90 * p;  // guess and lapse
+    if (u(rng) < p) {
+      uint64_t rt = (uint64_t)((200.0 + decision(rng)) * 1000);
+      hostSchedulePin(hostTime() + rt, LEVER, LOW);
+      hostSchedulePin(hostTime() + rt + 100000, LEVER, -1);
+    }
+  }
+  last = duty;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [-n sessions] [-t trials] [-p threads] [-s seed] [-q]\n"
+          "  -n  number of sessions (default 100)\n"
+          "  -t  trials per session (default 200)\n"
+          "  -p  sessions run at once (default: number of cores)\n"
+          "  -s  seed of the whole simulation (default 1)\n"
+          "  -q  discard the trial rows\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  unsigned sessions = 100;
+  unsigned trials = 200;
+  unsigned threads = 0;
+  uint32_t seed = 1;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      sessions = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      trials = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      threads = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      seed = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-q") == 0) {
+      quiet = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  Runner runner(threads);
+  auto t0 = std::chrono::steady_clock::now();
+  if (!quiet) {
+    printf("session\ttrial\tlevel\thit\trt\n");
+  }
+  uint64_t rows = runner.run(sessions, [&](unsigned id) {
+    // every session is reproducible from the seed regardless of the thread running it
+    std::seed_seq seq{seed, (uint32_t)id};
+    uint32_t seeds[2];
+    seq.generate(seeds, seeds + 2);
+
+    hostFastForward(60000000);
+    Task task = Task(trials, seeds[0] | 1);
+    Subject subject = Subject(seeds[1]);
+    while (!task.done()) {
+      task.loop();
+      subject.watch();
+      hostLoopDone();
+    }
+  }, quiet ? NULL : stdout);
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  fprintf(stderr, "%u sessions (%llu trials) in %.3f s on %u threads: %.1f sessions/s\n",
+          sessions, (unsigned long long)rows, sec, runner.threads(), sessions / sec);
+  return 0;
+}
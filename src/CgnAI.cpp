@@ -0,0 +1,311 @@
+/*!
+ * @file CgnAI.cpp
+ * @brief Definition of CgnAI class.
+ * @author Kei Mochizuki
+ * @example AI.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+CGN_LOCAL CgnAI *CgnAI::owner = NULL;
+bool CgnAI::installed = false;
+
+#if defined(__AVR__) && defined(ADC_vect)
+/*!
+ * @brief Selects the analog channel for the next conversion.
+ * @param c Channel number.
+**/
+static void select(byte c) {
+  ADMUX = _BV(REFS0) | (c & 7);
+#if defined(MUX5)
+  ADCSRB = (ADCSRB & ~_BV(MUX5)) | ((c & 8) ? _BV(MUX5) : 0);
+#endif
+}
+#define CGN_ADC 1
+#endif
+
+/*!
+ * @brief Constructor.
+ * @param firstPin First analog pin (\c A0 etc., or channel number).
+ * @param numberOfInputs Number of consecutive channels to be scanned.
+**/
+CgnAI::CgnAI(byte firstPin, byte numberOfInputs) {
+  first = (firstPin >= A0) ? firstPin - A0 : firstPin;
+  n = constrain(numberOfInputs, 1, N_CGNAI);
+  freeRun = false;
+  cur = 0;
+  mux = 0;
+  head = 0;
+  tail = 0;
+  lost = 0;
+  for (int i = 0; i < N_CGNAI; i++) {
+    latest[i] = 0;
+    stamp[i] = 0;
+  }
+}
+
+/*!
+ * @brief Starts the acquisition in background.
+ * @param rateHz Sampling rate of each channel in [Hz]
+ *        (\c 0 to let the converter run freely).
+ * @return Whether the acquisition started.
+ *         This fails when another instance is running,
+ *         when the rate is too high, or on unsupported boards.
+**/
+bool CgnAI::begin(uint16_t rateHz) {
+  if (owner != NULL && owner != this) {
+    return false;
+  }
+  end();
+  freeRun = (rateHz == 0);
+  cur = 0;
+  mux = 0;
+  head = 0;
+  tail = 0;
+  lost = 0;
+
+#if defined(CGN_ADC)
+  if (!installed) {
+    // no handler of the interrupt in the sketch (see CGN_AI_ISR)
+    return false;
+  }
+  uint32_t total = (uint32_t)rateHz * n;
+  byte ps;
+  // ADC clock needs 13 cycles per conversion, which must fit in a trigger period
+  if (freeRun || total <= 9000) {
+    ps = _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  } else if (total <= 18000) {
+    ps = _BV(ADPS2) | _BV(ADPS1);
+  } else if (total <= 36000) {
+    ps = _BV(ADPS2) | _BV(ADPS0);
+  } else {
+    return false;
+  }
+
+  byte s = SREG;
+  cli();
+  owner = this;
+  ADCSRA = 0;
+  ADCSRB = 0;
+  select(first);
+  if (!freeRun) {
+    // Timer1 in CTC mode raises compare match B at every trigger
+    uint32_t top = F_CPU / 8 / total;
+    byte cs = _BV(CS11);
+    if (top > 65536) {
+      top = F_CPU / 1024 / total;
+      cs = _BV(CS12) | _BV(CS10);
+    }
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    OCR1A = top - 1;
+    OCR1B = 0;
+    TIFR1 = _BV(OCF1B);
+    TCCR1B = _BV(WGM12) | cs;
+    ADCSRB |= _BV(ADTS2) | _BV(ADTS0);
+  }
+  ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | ps | (freeRun ? _BV(ADSC) : 0);
+  SREG = s;
+  return true;
+#elif defined(CGN_HOST)
+  owner = this;
+  hostAdc(convert, freeRun ? 104 : 1000000UL / ((uint32_t)rateHz * n));
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*!
+ * @brief Stops the acquisition.
+ * @note The converter (and Timer1) are set back as done by Arduino core.
+ *       Buffered samples can still be read.
+**/
+void CgnAI::end() {
+  if (owner != this) {
+    return;
+  }
+#if defined(CGN_ADC)
+  byte s = SREG;
+  cli();
+  ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  ADCSRB = 0;
+  if (!freeRun) {
+    TCCR1B = _BV(CS11) | _BV(CS10);
+    TCCR1A = _BV(WGM10);
+  }
+  SREG = s;
+#elif defined(CGN_HOST)
+  hostAdc(NULL, 0);
+#endif
+  owner = NULL;
+}
+
+/*!
+ * @brief Shows the latest value of @a i-th channel.
+ * @param i Index of the channel.
+ * @return Value of the latest conversion (\c 0 to \c 1023).
+ * @note When the acquisition is not running,
+ *       the channel is read by \c analogRead instead.
+**/
+int CgnAI::get(byte i) {
+  int v;
+  if (owner != this) {
+    return analogRead(first + i);
+  }
+#if defined(__AVR__)
+  byte s = SREG;
+  cli();
+#endif
+  v = latest[i];
+#if defined(__AVR__)
+  SREG = s;
+#endif
+  return v;
+}
+
+/*!
+ * @brief Shows when @a i-th channel was converted for the last time.
+ * @param i Index of the channel.
+ * @return Time of the latest conversion in [us] (i.e., in the unit of \c micros).
+**/
+uint32_t CgnAI::when(byte i) {
+  uint32_t t;
+#if defined(__AVR__)
+  byte s = SREG;
+  cli();
+#endif
+  t = stamp[i];
+#if defined(__AVR__)
+  SREG = s;
+#endif
+  return t;
+}
+
+/*!
+ * @brief Shows the number of buffered samples.
+ * @return Number of samples yet to be read.
+**/
+byte CgnAI::available() {
+  return (head - tail) & (N_CGNSAMPLE - 1);
+}
+
+/*!
+ * @brief Takes the oldest buffered sample.
+ * @param ch Channel index of the sample (given if not \c NULL).
+ * @param us Time of the sample in [us] (given if not \c NULL).
+ * @return Value of the sample (\c -1 if none is buffered).
+**/
+int CgnAI::read(byte *ch, uint32_t *us) {
+  byte t = tail;
+  int v;
+  if (t == head) {
+    return -1;
+  }
+  v = val[t];
+  if (ch != NULL) {
+    *ch = valCh[t];
+  }
+  if (us != NULL) {
+    *us = valUs[t];
+  }
+  tail = (t + 1) & (N_CGNSAMPLE - 1);
+  return v;
+}
+
+/*!
+ * @brief Takes a block of buffered samples.
+ * @param buf Array receiving the values.
+ * @param len Length of @a buf.
+ * @return Number of samples taken.
+ * @note Samples of the scanned channels come in turn.
+ *       Use the other \c read method to know the channel of each.
+**/
+byte CgnAI::read(int *buf, byte len) {
+  byte k = 0;
+  while (k < len && tail != head) {
+    byte t = tail;
+    buf[k++] = val[t];
+    tail = (t + 1) & (N_CGNSAMPLE - 1);
+  }
+  return k;
+}
+
+/*!
+ * @brief Shows the number of samples dropped by the overflow of the buffer.
+ * @return Number of dropped samples (saturates at \c BYTE_MAX).
+**/
+byte CgnAI::overflow() {
+  return lost;
+}
+
+/*!
+ * @brief Records that the sketch defines the handler of the ADC interrupt.
+ * @return Always \c true.
+ * @note This is called from cgnuino.h when \c CGN_AI_ISR is defined.
+**/
+bool CgnAI::install() {
+  installed = true;
+  return true;
+}
+
+/*!
+ * @brief Takes the result of a conversion (called from the ADC interrupt).
+**/
+void CgnAI::convert() {
+  CgnAI *a = owner;
+  if (a == NULL) {
+    return;
+  }
+#if defined(CGN_ADC)
+  a->store(ADC);
+  if (!a->freeRun) {
+    // the flag must be cleared for the next trigger
+    TIFR1 = _BV(OCF1B);
+  }
+#elif defined(CGN_HOST)
+  a->store(analogRead(a->first + a->cur));
+#endif
+}
+
+/*!
+ * @brief Stores a sample and selects the next channel.
+ * @param v Value of the conversion.
+ * @note In free running, the next conversion has already started
+ *       on the channel selected in the last call,
+ *       so the channel of the results lags one behind the selection.
+**/
+void CgnAI::store(int v) {
+  byte c = cur;
+  uint32_t t = micros();
+  byte h = head;
+  byte next = (h + 1) & (N_CGNSAMPLE - 1);
+
+  if (freeRun) {
+    cur = mux;
+  }
+  mux = (mux + 1 < n) ? mux + 1 : 0;
+#if defined(CGN_ADC)
+  if (n > 1) {
+    select(first + mux);
+  }
+#endif
+  if (!freeRun) {
+    cur = mux;
+  }
+
+  latest[c] = v;
+  stamp[c] = t;
+  if (next == tail) {
+    if (lost < BYTE_MAX) {
+      lost++;
+    }
+    return;
+  }
+  val[h] = v;
+  valCh[h] = c;
+  valUs[h] = t;
+  head = next;
+}
@@ -21,28 +21,50 @@ CgnAO::CgnAO(byte aoPin) {
 
 /*!
  * @brief Stops the analog output when finished determined time length of output.
- * @return Difference between intended and actual output lengths in [ms].
+ * @return Difference between intended and actual output lengths in [ms] (or [us], see CgnClock).
  *         \c ULONG_MAX is returned when termination of output did not occur.
  * @note For a normal usage, this method is intended to be called
  *       once inside \c loop function.
 **/
 uint32_t CgnAO::update() {
   uint32_t d = ULONG_MAX;
-  if(millis() >= limit) {
+  // the scheduler may clear the deadline from its interrupt
+  byte s = CgnScheduler::lock();
+  if (cgnClock.reached(limit)) {
     analogWrite(pin, 0);
-    d = millis() - limit;
+    d = cgnClock.raw() - limit;
     limit = ULONG_MAX;
   }
+  CgnScheduler::unlock(s);
   return d;
 }
 
 /*!
  * @brief Starts an analog output from a pin for determined time length.
- * @param aoMs Time length of output in [ms].
+ * @param aoMs Time length of output in [ms] (or [us], see CgnClock).
  * @param aoDuty Duty rate of pwm output within a range of [0, 255].
 **/
 void CgnAO::out(uint32_t aoMs, byte aoDuty) {
+  byte s = CgnScheduler::lock();
   analogWrite(pin, aoDuty);
-  limit = millis() + aoMs;
+  limit = cgnClock.after(aoMs);
+  CgnScheduler::post(limit, fire, this);
+  CgnScheduler::unlock(s);
+}
+
+/*!
+ * @brief Stops the analog output on behalf of CgnScheduler class.
+ * @param obj CgnAO instance that set the deadline.
+ * @param due Deadline registered to the scheduler.
+ * @return Whether the output was actually terminated.
+**/
+bool CgnAO::fire(void *obj, byte, uint32_t due) {
+  CgnAO *self = (CgnAO *)obj;
+  if (self->limit != due) {
+    return false;
+  }
+  analogWrite(self->pin, 0);
+  self->limit = ULONG_MAX;
+  return true;
 }
 
@@ -0,0 +1,231 @@
+/*!
+ * @file CgnClock.cpp
+ * @brief Definition of CgnClock class.
+ * @author Kei Mochizuki
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+CGN_LOCAL CgnClock cgnClock;
+CGN_LOCAL CgnClock::Hook CgnClock::hooks[N_CGNTICK];
+bool CgnClock::installed = false;
+
+#if defined(__AVR__) && defined(TIMER0_COMPA_vect)
+/*!
+ * @brief Switches the timer interrupt.
+ * @param on Whether to enable the interrupt.
+**/
+static void enable(bool on) {
+  if (on) {
+    TIMSK0 |= _BV(OCIE0A);
+  } else {
+    TIMSK0 &= ~_BV(OCIE0A);
+  }
+}
+#define CGN_TICKER 1
+#elif defined(CGN_HOST)
+/*!
+ * @brief Switches the 1-ms timer of the virtual board in host builds.
+ * @param on Whether to enable the timer.
+**/
+static void enable(bool on) {
+  hostTimer(on ? CgnClock::tick : NULL);
+}
+#define CGN_TICKER 1
+#endif
+
+/*!
+ * @brief Shows current time without touching the session clock.
+ * @return Current time in [ms] (or [us] when \c CGN_MICROS is set).
+ * @note Unlike \c now, this method can be safely called from interrupts.
+**/
+uint32_t CgnClock::raw() {
+#if CGN_MICROS
+  return micros();
+#else
+  return millis();
+#endif
+}
+
+/*!
+ * @brief Shows current time and extends the session clock.
+ * @return Current time in [ms] (or [us] when \c CGN_MICROS is set).
+**/
+uint32_t CgnClock::now() {
+  uint32_t t = raw();
+  if (t < lo) {
+    hi++;
+  }
+  lo = t;
+  return t;
+}
+
+/*!
+ * @brief Shows the time elapsed since the board started, without wrap around.
+ * @return Current time in [ms] (or [us] when \c CGN_MICROS is set) in 64 bits.
+ * @note The clock is extended every time \c now is called,
+ *       which is done by this method itself and by CgnStopwatch and CgnValtiel classes.
+ *       (The other classes check their deadlines by \c raw method
+ *       and leave the clock as it is.)
+ *       It stays correct as long as any of them is called
+ *       at least once in every ~49.7 days (or ~71.6 minutes with \c CGN_MICROS),
+ *       so call this method often enough in your sketch
+ *       if none of those classes is in use.
+**/
+uint64_t CgnClock::session() {
+  now();
+  return ((uint64_t)hi << 32) | lo;
+}
+
+/*!
+ * @brief Computes the deadline a given time length after now.
+ * @param len Time length in [ms] (or [us] when \c CGN_MICROS is set).
+ *        \c ULONG_MAX means that the deadline never comes,
+ *        and other values are clipped to \c CGN_SPAN_MAX.
+ * @return Deadline to be checked by \c reached method.
+**/
+uint32_t CgnClock::after(uint32_t len) {
+  uint32_t t;
+  if (len == ULONG_MAX) {
+    return ULONG_MAX;
+  }
+  t = raw() + min(len, CGN_SPAN_MAX);
+#if defined(CGN_HOST)
+  hostDeadline(min(len, CGN_SPAN_MAX), CGN_MICROS);
+#endif
+  return (t == ULONG_MAX) ? 0 : t;
+}
+
+/*!
+ * @brief Checks whether a deadline has been reached, even across the wrap around.
+ * @param deadline Deadline computed by \c after method.
+ * @return Whether the deadline has been reached.
+ *         \c false is always returned for \c ULONG_MAX (i.e., no deadline).
+**/
+bool CgnClock::reached(uint32_t deadline) {
+  return reached(deadline, raw());
+}
+
+/*!
+ * @brief Checks whether a deadline has been reached at a given time.
+ * @param deadline Deadline computed by \c after method.
+ * @param t Time to be examined.
+ * @return Whether the deadline has been reached.
+**/
+bool CgnClock::reached(uint32_t deadline, uint32_t t) {
+  return deadline != ULONG_MAX && (int32_t)(t - deadline) >= 0;
+}
+
+/*!
+ * @brief Compares two deadlines, even across the wrap around.
+ * @param a First deadline.
+ * @param b Second deadline.
+ * @return Whether \a a comes before \a b.
+**/
+bool CgnClock::earlier(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) < 0;
+}
+
+/*!
+ * @brief Attaches a function to be called in every ~1 ms from timer interrupt.
+ * @param fn Function to be called.
+ * @param obj Object passed to \a fn.
+ * @return Whether the function was attached.
+ *         \c false is returned when the board does not support
+ *         the timer interrupt or \c N_CGNTICK functions are already attached.
+**/
+bool CgnClock::attach(void (*fn)(void *), void *obj) {
+#if defined(CGN_TICKER)
+  bool ok = false;
+#if defined(__AVR__)
+  if (!installed) {
+    // no handler of the interrupt in the sketch (see CGN_CLOCK_ISR)
+    return false;
+  }
+  byte s = SREG;
+  cli();
+#endif
+  for (int k = 0; k < N_CGNTICK; k++) {
+    if (hooks[k].fn == NULL || (hooks[k].fn == fn && hooks[k].obj == obj)) {
+      hooks[k].obj = obj;
+      hooks[k].fn = fn;
+      ok = true;
+      break;
+    }
+  }
+  if (ok) {
+    enable(true);
+  }
+#if defined(__AVR__)
+  SREG = s;
+#endif
+  return ok;
+#else
+  return false;
+#endif
+}
+
+/*!
+ * @brief Detaches a function attached by \c attach method.
+ * @param fn Function to be detached.
+ * @param obj Object given on attachment.
+**/
+void CgnClock::detach(void (*fn)(void *), void *obj) {
+#if defined(CGN_TICKER)
+  bool used = false;
+#if defined(__AVR__)
+  byte s = SREG;
+  cli();
+#endif
+  for (int k = 0; k < N_CGNTICK; k++) {
+    if (hooks[k].fn == fn && hooks[k].obj == obj) {
+      hooks[k].fn = NULL;
+    }
+    used = used || hooks[k].fn != NULL;
+  }
+  if (!used) {
+    enable(false);
+  }
+#if defined(__AVR__)
+  SREG = s;
+#endif
+#endif
+}
+
+/*!
+ * @brief Records that the sketch defines the handler of the timer interrupt.
+ * @return Always \c true.
+ * @note This is called from cgnuino.h when \c CGN_CLOCK_ISR is defined.
+ *       The handler piggybacks on Timer0 which already runs \c millis,
+ *       so it fires once in every ~1 ms just after \c millis is counted up.
+**/
+bool CgnClock::install() {
+  installed = true;
+  return true;
+}
+
+#if CGN_MICROS
+/*!
+ * @brief Confirms that the library is built with \c CGN_MICROS.
+ * @return Always \c true.
+ * @note This is called from cgnuino.h when \c CGN_MICROS is set,
+ *       and is defined only when the library is built with it.
+ *       A sketch that defines \c CGN_MICROS by itself thus fails to link.
+**/
+bool CgnClock::inMicros() {
+  return true;
+}
+#endif
+
+/*!
+ * @brief Calls all the attached functions.
+ * @note This is called from the timer interrupt once in every ~1 ms.
+**/
+void CgnClock::tick() {
+  for (int k = 0; k < N_CGNTICK; k++) {
+    if (hooks[k].fn != NULL) {
+      hooks[k].fn(hooks[k].obj);
+    }
+  }
+}
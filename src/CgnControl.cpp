@@ -14,49 +14,117 @@
 **/
 CgnControl::CgnControl(char endOfLine) {
   c = 0;
-  v = "";
   eol = endOfLine;
+  len = 0;
+  val = 0;
+  line[0] = '\0';
+  done = false;
+  drop = false;
 }
 
 /*!
  * @brief Checks the serial buffer for a new input line.
- * @return Received value from the Serial input.
+ * @return Received value from the Serial input
+ *         (empty when no complete line has arrived).
+ * @note This method works in the same way as \c poll,
+ *       and returns the value as a String object.
+ *       Use \c poll to avoid heap allocation.
 **/
 String CgnControl::update() {
-  int i;
-  String s;
+  poll();
+  return getValue();
+}
 
-  c = 0;
-  v = "";
-  if (Serial.available() > 0) {
-    s = Serial.readStringUntil(eol);
-    s.trim();
-    if (s.length() > 0) {
-      if (s.length() == 1) {
-        // for one-character command
-        c = int(s[0]);
-      } else {
-        i = s.indexOf(":");
-        if (i == -1) {
-          // when separater did not exist
-          v = s;
-        } else {
-          // for online variable modulation
-          v = s.substring(i + 1);
-          v.trim();
-          s = s.substring(0, i); // this does not include i-th char
-          s.trim();
-          c = s.toInt();
-        }
+/*!
+ * @brief Checks the serial buffer for a new input line without heap allocation.
+ * @return Whether a complete line has been received.
+ *         The received code and value are obtained by \c getCode, \c getText,
+ *         \c getInt and \c getFloat methods until the next call.
+ * @note Only the bytes already received are consumed,
+ *       so this method never waits for the rest of a line.
+**/
+bool CgnControl::poll() {
+  int b;
+
+  if (done) {
+    // forget the line handled in the last call
+    len = 0;
+    val = 0;
+    line[0] = '\0';
+    c = 0;
+    done = false;
+  }
+
+  while (Serial.available() > 0) {
+    b = Serial.read();
+    if (b < 0) {
+      break;
+    }
+    if (b == eol) {
+      if (drop) {
+        // discard overlong line
+        len = 0;
+        line[0] = '\0';
+        drop = false;
+        continue;
       }
+      line[len] = '\0';
+      parse();
+      done = true;
+      break;
+    }
+    if (len < N_CGNCONTROL) {
+      line[len++] = b;
+    } else {
+      drop = true;
     }
   }
-  return v;
+  return done;
+}
+
+/*!
+ * @brief Decomposes a received line into code and value.
+**/
+void CgnControl::parse() {
+  byte from = 0, to = len, i;
+
+  while (from < to && isspace(line[from])) {
+    from++;
+  }
+  while (to > from && isspace(line[to - 1])) {
+    to--;
+  }
+  line[to] = '\0';
+
+  if (to - from == 1) {
+    // for one-character command
+    c = (byte)line[from];
+    val = to;
+    return;
+  }
+
+  i = from;
+  while (i < to && line[i] != ':') {
+    i++;
+  }
+  if (i == to) {
+    // when separater did not exist
+    val = from;
+    return;
+  }
+
+  // for online variable modulation
+  line[i] = '\0';
+  c = atoi(line + from);
+  val = i + 1;
+  while (val < to && isspace(line[val])) {
+    val++;
+  }
 }
 
 /*!
  * @brief Shows decomposed code for the last serial input.
- * @return Code for conditional branching received by last \c update execution.
+ * @return Code for conditional branching received by last \c update (or \c poll) execution.
 **/
 int CgnControl::getCode() {
   return c;
@@ -65,8 +133,33 @@ int CgnControl::getCode() {
 /*!
  * @brief Shows decomposed value for the last serial input.
  * @return Value received by last \c update execution.
+ * @note This method creates a String object.
+ *       Use \c getText, \c getInt or \c getFloat to avoid heap allocation.
 **/
 String CgnControl::getValue() {
-  return v;
+  return String(getText());
 }
 
+/*!
+ * @brief Shows decomposed value for the last serial input without copying it.
+ * @return Value received by last \c update (or \c poll) execution (valid until the next call).
+**/
+const char *CgnControl::getText() {
+  return done ? line + val : "";
+}
+
+/*!
+ * @brief Shows decomposed value for the last serial input as an integer.
+ * @return Value received by last \c update execution (\c 0 if not a number).
+**/
+long CgnControl::getInt() {
+  return atol(getText());
+}
+
+/*!
+ * @brief Shows decomposed value for the last serial input as a floating point value.
+ * @return Value received by last \c update execution (\c 0 if not a number).
+**/
+float CgnControl::getFloat() {
+  return atof(getText());
+}
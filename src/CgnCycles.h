@@ -0,0 +1,301 @@
+/*!
+ * @file CgnCycles.h
+ * @brief Header-only cycle counter for profiling cgnuino on the target.
+ * @author Kei Mochizuki
+ * @example CyclesIO.ino
+ * @example CyclesTask.ino
+**/
+
+#ifndef INCLUDED_CGNCYCLES
+#define INCLUDED_CGNCYCLES
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Counts CPU cycles taken by a piece of code.
+ *
+ * Time measured by \c micros function has a resolution of 4 us
+ * on 16 MHz AVR boards, which is longer than most methods of cgnuino.
+ * CgnCycles class instead counts the clock cycles of the CPU,
+ * so that the cost of each \c update or \c out can be compared
+ * among boards and against the time budget of your \c loop.
+ * It is not included by cgnuino.h,
+ * since it takes over a hardware timer as below.
+ * Include CgnCycles.h in a profiling sketch only.
+ *
+ * On AVR boards, \c begin method runs Timer1 without prescaler
+ * (i.e., counting at 16 MHz on most boards),
+ * and \c end method gives it back to the setting made by Arduino core.
+ * PWM outputs on Timer1 (pins 9 and 10 on Uno, pins 11 and 12 on Mega)
+ * and libraries using Timer1 (e.g., Servo on Uno) cannot be used in between.
+ * The counter has 16 bits, so one measurement can last up to 65535 cycles
+ * (~4 ms at 16 MHz); longer ones are reported as \c ULONG_MAX.
+ * On ARM Cortex-M3/M4/M7 boards, the cycle counter of DWT unit is used,
+ * which is 32-bit and free from other functions.
+ * On other boards (and in the host build),
+ * cycles are estimated from \c micros function.
+ *
+ * Call \c start and \c stop around the code,
+ * or pass the code to \c measure method as a function.
+ * The cycles taken by \c start and \c stop themselves
+ * are measured by \c begin and subtracted.
+ * Each instance keeps the minimum, mean and maximum of its measurements,
+ * which are printed as a row of a table by \c out method.
+ * The minimum is the cost of the code itself,
+ * while the mean and maximum include interrupts
+ * (e.g., ~100 cycles of Timer0 every 1 ms on AVR).
+ *
+ * \code
+ * CgnCycles cyc = CgnCycles();
+ *
+ * CgnCycles::begin();
+ * cyc.measure([]() { di.update(); });
+ * cyc.out(F("CgnDI::update"));
+ * \endcode
+**/
+class CgnCycles {
+  public:
+    CgnCycles();
+    static bool begin();
+    static void end();
+    static uint32_t now();
+    void start();
+    uint32_t stop();
+    void measure(void (*)(), byte = 32);
+    void reset();
+    uint32_t getMin();
+    uint32_t getMean();
+    uint32_t getMax();
+    uint32_t count();
+    void out(const __FlashStringHelper *);
+
+  private:
+    static uint32_t &base();
+    uint32_t from;
+    uint32_t n;
+    uint64_t sum;
+    uint32_t mn;
+    uint32_t mx;
+};
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define CGN_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define CGN_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define CGN_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+#define CGN_DWT_LAR (*(volatile uint32_t *)0xE0001FB0)
+#endif
+
+/*!
+ * @brief Constructor.
+**/
+inline CgnCycles::CgnCycles() {
+  from = 0;
+  reset();
+}
+
+/*!
+ * @brief Starts the cycle counter and measures the cost of measurement.
+ * @return Whether the hardware counter is available
+ *         (otherwise cycles are estimated from \c micros).
+**/
+inline bool CgnCycles::begin() {
+  bool hard = false;
+  CgnCycles c;
+
+#if defined(__AVR__) && defined(TCNT1)
+  byte s = SREG;
+  cli();
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TIMSK1 = 0;
+  SREG = s;
+  hard = true;
+#elif defined(CGN_DWT_CYCCNT)
+  CGN_DEMCR |= (1UL << 24);
+  CGN_DWT_LAR = 0xC5ACCE55;
+  CGN_DWT_CYCCNT = 0;
+  CGN_DWT_CTRL |= 1UL;
+  hard = true;
+#endif
+
+  // the fastest of repeated empty measurements is the cost of start and stop
+  base() = 0;
+  for (byte i = 0; i < 16; i++) {
+    c.start();
+    c.stop();
+  }
+  base() = c.getMin();
+  return hard;
+}
+
+/*!
+ * @brief Stops the cycle counter.
+ * @note On AVR boards, Timer1 is set back to 8-bit phase correct PWM
+ *       with the prescaler of 64 as done by Arduino core.
+**/
+inline void CgnCycles::end() {
+#if defined(__AVR__) && defined(TCNT1)
+  byte s = SREG;
+  cli();
+  TCCR1B = _BV(CS11) | _BV(CS10);
+  TCCR1A = _BV(WGM10);
+  SREG = s;
+#elif defined(CGN_DWT_CYCCNT)
+  CGN_DWT_CTRL &= ~1UL;
+#endif
+}
+
+/*!
+ * @brief Reads the cycle counter.
+ * @return Cycles counted by the hardware
+ *         (wraps at 16 bits on AVR boards and 32 bits on ARM boards).
+**/
+inline uint32_t CgnCycles::now() {
+#if defined(__AVR__) && defined(TCNT1)
+  byte s = SREG;
+  cli();
+  uint16_t t = TCNT1;
+  SREG = s;
+  return t;
+#elif defined(CGN_DWT_CYCCNT)
+  return CGN_DWT_CYCCNT;
+#else
+  return micros() * clockCyclesPerMicrosecond();
+#endif
+}
+
+/*!
+ * @brief Starts a measurement.
+**/
+inline void CgnCycles::start() {
+#if defined(__AVR__) && defined(TCNT1)
+  // restarting the counter lets its overflow flag tell a too long measurement
+  byte s = SREG;
+  cli();
+  TIFR1 = _BV(TOV1);
+  TCNT1 = 0;
+  SREG = s;
+#else
+  from = now();
+#endif
+}
+
+/*!
+ * @brief Ends a measurement and adds it to the statistics.
+ * @return Cycles taken from \c start
+ *         (\c ULONG_MAX if the counter overflowed, which is not averaged).
+**/
+inline uint32_t CgnCycles::stop() {
+  uint32_t c;
+#if defined(__AVR__) && defined(TCNT1)
+  byte s = SREG;
+  cli();
+  c = TCNT1;
+  bool over = TIFR1 & _BV(TOV1);
+  SREG = s;
+  if (over) {
+    mx = ULONG_MAX;
+    return ULONG_MAX;
+  }
+#else
+  c = now() - from;
+#endif
+  c = (c > base()) ? c - base() : 0;
+  n++;
+  sum += c;
+  mn = min(mn, c);
+  mx = max(mx, c);
+  return c;
+}
+
+/*!
+ * @brief Measures a function repeatedly.
+ * @param fn Function to be measured (e.g., a lambda calling a method).
+ * @param repeat Number of measurements.
+ * @note The serial output is flushed beforehand so that
+ *       its interrupts do not disturb the measurements.
+ *       The cycles include the call of @a fn itself (a few to ~10 cycles).
+**/
+inline void CgnCycles::measure(void (*fn)(), byte repeat) {
+  Serial.flush();
+  for (byte i = 0; i < repeat; i++) {
+    start();
+    fn();
+    stop();
+  }
+}
+
+/*!
+ * @brief Forgets the measurements so far.
+**/
+inline void CgnCycles::reset() {
+  n = 0;
+  sum = 0;
+  mn = ULONG_MAX;
+  mx = 0;
+}
+
+/*!
+ * @brief Shows the fewest cycles measured.
+ * @return Cycles (\c ULONG_MAX if nothing was measured).
+**/
+inline uint32_t CgnCycles::getMin() {
+  return mn;
+}
+
+/*!
+ * @brief Shows the mean of the cycles measured.
+ * @return Cycles (\c 0 if nothing was measured).
+**/
+inline uint32_t CgnCycles::getMean() {
+  return (n > 0) ? (uint32_t)(sum / n) : 0;
+}
+
+/*!
+ * @brief Shows the most cycles measured.
+ * @return Cycles (\c ULONG_MAX if any measurement overflowed).
+**/
+inline uint32_t CgnCycles::getMax() {
+  return mx;
+}
+
+/*!
+ * @brief Shows the number of measurements.
+ * @return Number of measurements (excluding overflowed ones).
+**/
+inline uint32_t CgnCycles::count() {
+  return n;
+}
+
+/*!
+ * @brief Emits the statistics as a row of a table and forgets them.
+ * @param label Name of the measured code placed at the head of the row.
+ * @note The row consists of label, count, minimum, mean and maximum cycles,
+ *       and the minimum in [ns], separated by tabs.
+**/
+inline void CgnCycles::out(const __FlashStringHelper *label) {
+  Serial.print(label);
+  Serial.print('\t');
+  Serial.print(n);
+  Serial.print('\t');
+  Serial.print(mn);
+  Serial.print('\t');
+  Serial.print(getMean());
+  Serial.print('\t');
+  Serial.print(mx);
+  Serial.print('\t');
+  Serial.println((n > 0) ? mn * 1000.0 / clockCyclesPerMicrosecond() : 0.0, 0);
+  reset();
+}
+
+/*!
+ * @brief Keeps the cycles taken by \c start and \c stop.
+ * @return Reference to the cycles subtracted from every measurement.
+**/
+inline uint32_t &CgnCycles::base() {
+  static uint32_t cycles = 0;
+  return cycles;
+}
+
+#endif
@@ -1,6 +1,6 @@
 /*!
  * @file CgnDI.cpp
- * @brief Definition of CgnDI class.
+ * @brief Definition of CgnDIBase class.
  * @author Kei Mochizuki
  * @example DI.ino
 **/
@@ -8,37 +8,218 @@
 #include "Arduino.h"
 #include "cgnuino.h"
 
+CGN_LOCAL CgnDIBase *CgnDIBase::slotOwner[N_CGNISR];
+CGN_LOCAL byte CgnDIBase::slotCh[N_CGNISR];
+void (*const CgnDIBase::hooks[N_CGNISR])() = {
+  isr<0>, isr<1>, isr<2>, isr<3>, isr<4>, isr<5>, isr<6>, isr<7>
+};
+
+/*!
+ * @brief Interrupt service routine for a given slot of edge capture.
+ * @tparam K Index of the slot.
+**/
+template <byte K>
+void CgnDIBase::isr() {
+  slotOwner[K]->edge(slotCh[K]);
+}
+
 /*!
  * @brief Constructor.
+ * @param counters Storage of the debounce counters of the pins (at least @a size elements).
+ * @param size Maximal number of pins (up to 32).
  * @param firstPin First pin number for digital-in pins.
  * @param numberOfInputs Number of digital inputs in use.
  * @param relaidPin First pin number for relaied output pins if needed.
  * @param debounceMs Delay intervened after a bit change in [ms].
 **/
-CgnDI::CgnDI(byte firstPin, byte numberOfInputs, byte relaidPin, byte debounceMs) {
+CgnDIBase::CgnDIBase(byte *counters, byte size, byte firstPin, byte numberOfInputs, byte relaidPin, byte debounceMs) {
+  rest = counters;
   first = firstPin;
-  n = numberOfInputs;
+  n = min(numberOfInputs, min(size, (byte)32));
   relay = relaidPin;
-  relaid = (relay != NULL);
+  relaid = (relay != 0);
   r = debounceMs;
   last = millis();
+  stamp = micros();
+  ported = false;
+  edges = NULL;
 
-  for (int i = 0; i < N_CGNDI; i++) {
+  for (int i = 0; i < n; i++) {
     rest[i] = 0;
-    if (i < n) {
-      pinMode(first + i, INPUT_PULLUP);
-      cur[i] = digitalRead(first + i) ? false : true;
-      pre[i] = cur[i];
-
-      if (relaid) {
-        pinMode(relay + i, OUTPUT);
-        digitalWrite(relay + i, cur[i] ? HIGH : LOW);
+    pinMode(first + i, INPUT_PULLUP);
+  }
+
+  cur = sample();
+  pre = cur;
+  if (relaid) {
+    for (int i = 0; i < n; i++) {
+      pinMode(relay + i, OUTPUT);
+      digitalWrite(relay + i, on(i) ? HIGH : LOW);
+    }
+  }
+}
+
+/*!
+ * @brief Points the instance to its own storage after it was copied.
+ * @param counters Storage of the debounce counters, already copied from the original.
+ * @note The copy is not attached to interrupts, even if the original is.
+**/
+void CgnDIBase::rebind(byte *counters) {
+  rest = counters;
+  edges = NULL;
+}
+
+/*!
+ * @brief Switches sampling of the pins to port-register batch reading.
+ * @param enable Whether to read each underlying GPIO port once per \c update.
+ * @return Whether batch reading is actually in use.
+ *         \c false is returned on boards without direct port access,
+ *         where pins are still read one by one by \c digitalRead.
+**/
+bool CgnDIBase::batch(bool enable) {
+  ported = false;
+#if defined(__AVR__)
+  if (enable) {
+    for (int i = 0; i < n; i++) {
+      byte k = digitalPinToPort(first + i);
+      if (k == NOT_A_PIN || k >= 16) {
+        return false;
       }
-    } else {
-      cur[i] = false;
-      pre[i] = false;
+    }
+    ported = true;
+  }
+#else
+  (void)enable;
+#endif
+  return ported;
+}
+
+/*!
+ * @brief Reads raw (not debounced) states of all the pins at once.
+ * @return Bitmask of active pins (\c i-th bit for \c i-th input).
+**/
+uint32_t CgnDIBase::sample() {
+  uint32_t raw = 0;
+#if defined(__AVR__)
+  if (ported) {
+    // every port in use is read once before the pins are decoded
+    // (the ports and bits are looked up from the flash tables of the core,
+    // so that no storage is needed for each pin)
+    byte snap[16];
+    uint16_t seen = 0;
+    for (int i = 0; i < n; i++) {
+      byte k = digitalPinToPort(first + i);
+      if (!(seen & (1 << k))) {
+        seen |= 1 << k;
+        snap[k] = *portInputRegister(k);
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      if (!(snap[digitalPinToPort(first + i)] & digitalPinToBitMask(first + i))) {
+        raw |= (uint32_t)1 << i;
+      }
+    }
+    return raw;
+  }
+#endif
+  for (int i = 0; i < n; i++) {
+    if (!digitalRead(first + i)) {
+      raw |= (uint32_t)1 << i;
     }
   }
+  return raw;
+}
+
+/*!
+ * @brief Starts interrupt-driven edge capture of the pins.
+ * @param buffer Buffer receiving the captured edges (used only by this instance).
+ * @return Whether all the pins were successfully attached to interrupts.
+ *         \c false is returned when any of the pins has no external interrupt
+ *         or no more slot for interrupt service routine is left,
+ *         in which case the pins are kept polled as usual.
+**/
+bool CgnDIBase::attach(CgnEdges &buffer) {
+  int irq;
+  byte k;
+
+  if (edges != NULL) {
+    return true;
+  }
+  if (n > N_CGNISR) {
+    return false;
+  }
+  buffer.head = 0;
+  buffer.tail = 0;
+  buffer.lost = 0;
+  for (int i = 0; i < n; i++) {
+    buffer.stamp[i] = micros() - (uint32_t)r * 1000;
+  }
+  edges = &buffer;
+
+  for (int i = 0; i < n; i++) {
+    irq = digitalPinToInterrupt(first + i);
+    k = 0;
+    while (k < N_CGNISR && slotOwner[k] != NULL) {
+      k++;
+    }
+    if (irq == NOT_AN_INTERRUPT || k == N_CGNISR) {
+      detach();
+      return false;
+    }
+    slotOwner[k] = this;
+    slotCh[k] = i;
+    attachInterrupt(irq, hooks[k], CHANGE);
+  }
+  return true;
+}
+
+/*!
+ * @brief Stops interrupt-driven edge capture and returns to polling.
+**/
+void CgnDIBase::detach() {
+  for (int k = 0; k < N_CGNISR; k++) {
+    if (slotOwner[k] == this) {
+      detachInterrupt(digitalPinToInterrupt(first + slotCh[k]));
+      slotOwner[k] = NULL;
+    }
+  }
+  edges = NULL;
+}
+
+/*!
+ * @brief Pushes a pin change into the edge buffer (called from interrupt).
+ * @param i Index of the changed input.
+**/
+void CgnDIBase::edge(byte i) {
+  CgnEdges *e = edges;
+  byte h = e->head;
+  byte next = (h + 1) & (N_CGNEDGE - 1);
+  if (next == e->tail) {
+    if (e->lost < BYTE_MAX) {
+      e->lost++;
+    }
+    return;
+  }
+  e->us[h] = micros();
+  e->ch[h] = i;
+  e->level[h] = !digitalRead(first + i);
+  e->head = next;
+}
+
+/*!
+ * @brief Flips the debounced state of @a i-th DI pin.
+ * @param i Index of the changed input.
+ * @param us Time of the change in [us].
+**/
+void CgnDIBase::toggle(byte i, uint32_t us) {
+  cur ^= (uint32_t)1 << i;
+  stamp = us;
+  if (edges != NULL) {
+    edges->stamp[i] = us;
+  }
+  if (relaid) {
+    digitalWrite(relay + i, on(i) ? HIGH : LOW);
+  }
 }
 
 /*!
@@ -47,39 +228,91 @@ CgnDI::CgnDI(byte firstPin, byte numberOfInputs, byte relaidPin, byte debounceMs
  * @note For a normal usage, this method is intended to be called
  *       once, and only once, inside \c loop function.
 **/
-uint32_t CgnDI::update() {
-  uint32_t past;
+uint32_t CgnDIBase::update() {
+  uint32_t past, raw, now, gap;
+  CgnEdges *e = edges;
   past = millis() - last;
   last = millis();
 
+  pre = cur;
+  if (e != NULL) {
+    // replay captured edges with their own timestamps
+    gap = (uint32_t)r * 1000;
+    while (e->tail != e->head) {
+      byte t = e->tail;
+      byte i = e->ch[t];
+      bool level = e->level[t];
+      uint32_t us = e->us[t];
+      e->tail = (t + 1) & (N_CGNEDGE - 1);
+      if (level != on(i) && us - e->stamp[i] >= gap) {
+        toggle(i, us);
+      }
+    }
+
+    // catch up with edges swallowed by debouncing or buffer overflow
+    raw = sample();
+    now = micros();
+    for (int i = 0; i < n; i++) {
+      if (((raw ^ cur) >> i) & 1 && now - e->stamp[i] >= gap) {
+        toggle(i, now);
+      }
+    }
+    return past;
+  }
+
+  raw = sample();
+  now = micros();
   for (int i = 0; i < n; i++) {
-    pre[i] = cur[i];
     if (rest[i] > past) {
       rest[i] -= past;
       continue;
 
     } else {
       rest[i] = 0;
-      cur[i] = digitalRead(first + i) ? false : true;
-
-      if (cur[i] != pre[i]) {
+      if (((raw ^ cur) >> i) & 1) {
+        toggle(i, now);
         rest[i] = r;
-        if (relaid) {
-          digitalWrite(relay + i, cur[i] ? HIGH : LOW);
-        }
+#if defined(CGN_HOST)
+        // let the host build know when the dead time ends
+        hostDeadline(r, false);
+#endif
       }
     }
   }
   return past;
 }
 
+/*!
+ * @brief Shows when @a i-th DI pin changed its state for the last time.
+ * @param i Index of input you want to check.
+ * @return Time of the last change in [us] (i.e., in the unit of \c micros).
+ * @note Under interrupt-driven edge capture (see \c attach),
+ *       this is the exact time of the edge regardless of loop latency.
+ *       Otherwise this is the time of the last \c update that detected
+ *       a change of any pin, which is that of @a i-th pin
+ *       in the loop where \c change of the pin is \c true.
+**/
+uint32_t CgnDIBase::when(byte i) {
+  CgnEdges *e = edges;
+  return (e != NULL) ? e->stamp[i] : stamp;
+}
+
+/*!
+ * @brief Shows the number of edges dropped by the overflow of edge buffer.
+ * @return Number of dropped edges (saturates at \c BYTE_MAX).
+**/
+byte CgnDIBase::overflow() {
+  CgnEdges *e = edges;
+  return (e != NULL) ? e->lost : 0;
+}
+
 /*!
  * @brief Checks whether @a i-th DI pin is on (active).
  * @param i Index of input you want to check.
  * @return Result of the examined pin state.
 **/
-bool CgnDI::on(byte i) {
-  return cur[i];
+bool CgnDIBase::on(byte i) {
+  return (cur >> i) & 1;
 }
 
 /*!
@@ -87,8 +320,8 @@ bool CgnDI::on(byte i) {
  * @param i Index of input you want to check.
  * @return Result of the examined pin state.
 **/
-bool CgnDI::off(byte i) {
-  return !cur[i];
+bool CgnDIBase::off(byte i) {
+  return !((cur >> i) & 1);
 }
 
 /*!
@@ -96,8 +329,8 @@ bool CgnDI::off(byte i) {
  * @param i Index of input you want to check.
  * @return Result of the examined pin state.
 **/
-bool CgnDI::turnon(byte i) {
-  return cur[i] && !pre[i];
+bool CgnDIBase::turnon(byte i) {
+  return (turnonMask() >> i) & 1;
 }
 
 /*!
@@ -105,8 +338,8 @@ bool CgnDI::turnon(byte i) {
  * @param i Index of input you want to check.
  * @return Result of the examined pin state.
 **/
-bool CgnDI::turnoff(byte i) {
-  return !cur[i] && pre[i];
+bool CgnDIBase::turnoff(byte i) {
+  return (turnoffMask() >> i) & 1;
 }
 
 /*!
@@ -114,8 +347,8 @@ bool CgnDI::turnoff(byte i) {
  * @param i Index of input you want to check.
  * @return Result of the examined pin state.
 **/
-bool CgnDI::change(byte i) {
-  return cur[i] != pre[i];
+bool CgnDIBase::change(byte i) {
+  return ((cur ^ pre) >> i) & 1;
 }
 
 /*!
@@ -123,7 +356,62 @@ bool CgnDI::change(byte i) {
  * @param i Index of input you want to check.
  * @return Result of the examined pin state.
 **/
-bool CgnDI::keep(byte i) {
-  return cur[i] == pre[i];
+bool CgnDIBase::keep(byte i) {
+  return !(((cur ^ pre) >> i) & 1);
 }
 
+/*!
+ * @brief Shows which DI pins are on (active).
+ * @return Bitmask of the pin states (\c i-th bit for \c i-th input).
+**/
+uint32_t CgnDIBase::onMask() {
+  return cur;
+}
+
+/*!
+ * @brief Shows which DI pins are off (inactive).
+ * @return Bitmask of the pin states (\c i-th bit for \c i-th input).
+**/
+uint32_t CgnDIBase::offMask() {
+  return ~cur & all();
+}
+
+/*!
+ * @brief Shows which DI pins were turned on in current loop.
+ * @return Bitmask of the pin states (\c i-th bit for \c i-th input).
+**/
+uint32_t CgnDIBase::turnonMask() {
+  return cur & ~pre;
+}
+
+/*!
+ * @brief Shows which DI pins were turned off in current loop.
+ * @return Bitmask of the pin states (\c i-th bit for \c i-th input).
+**/
+uint32_t CgnDIBase::turnoffMask() {
+  return ~cur & pre;
+}
+
+/*!
+ * @brief Shows which DI pins were changed from previous loop.
+ * @return Bitmask of the pin states (\c i-th bit for \c i-th input).
+**/
+uint32_t CgnDIBase::changeMask() {
+  return cur ^ pre;
+}
+
+/*!
+ * @brief Shows which DI pins kept unchanged from previous loop.
+ * @return Bitmask of the pin states (\c i-th bit for \c i-th input).
+**/
+uint32_t CgnDIBase::keepMask() {
+  return ~(cur ^ pre) & all();
+}
+
+/*!
+ * @brief Shows the bitmask covering all the pins in use.
+ * @return Bitmask with lowest @a n bits set.
+**/
+uint32_t CgnDIBase::all() {
+  return (n >= 32) ? ULONG_MAX : (((uint32_t)1 << n) - 1);
+}
@@ -1,9 +1,10 @@
 /*!
  * @file CgnDO.cpp
- * @brief Definition of CgnDO class.
+ * @brief Definition of CgnDOBase class.
  * @author Kei Mochizuki
  * @example Lchika.ino
  * @example LchikaWave.ino
+ * @example LchikaMask.ino
 **/
 
 #include "Arduino.h"
@@ -11,48 +12,204 @@
 
 /*!
  * @brief Consructor.
+ * @param channels Storage of the states of the pins (at least @a size elements).
+ * @param size Maximal number of pins (up to 32).
  * @param firstPin First pin number for digital-out pins.
  * @param numberOfOutputs Number of digital outputs in use.
 **/
-CgnDO::CgnDO(byte firstPin, byte numberOfOutputs) {
-  first = firstPin;
-  n = numberOfOutputs;
+CgnDOBase::CgnDOBase(Channel *channels, byte size, byte firstPin, byte numberOfOutputs) {
+  ch = channels;
+  n = min(numberOfOutputs, min(size, (byte)32));
+  for (int i = 0; i < n; i++) {
+    ch[i].pin = firstPin + i;
+  }
+  init();
+}
 
-  for (int i = 0; i < N_CGNDO; i++) {
-    limit[i] = ULONG_MAX;
-    if (i < n) {
-      pinMode(first + i, OUTPUT);
-      digitalWrite(first + i, LOW);
-    }
+/*!
+ * @brief Consructor.
+ * @param channels Storage of the states of the pins (at least @a size elements).
+ * @param size Maximal number of pins (up to 32).
+ * @param pins Array of pin numbers for digital-out pins.
+ * @param numberOfOutputs Number of digital outputs in use (length of @a pins).
+**/
+CgnDOBase::CgnDOBase(Channel *channels, byte size, const byte *pins, byte numberOfOutputs) {
+  ch = channels;
+  n = min(numberOfOutputs, min(size, (byte)32));
+  for (int i = 0; i < n; i++) {
+    ch[i].pin = pins[i];
   }
+  init();
+}
+
+/*!
+ * @brief Prepares the pins as digital outputs.
+**/
+void CgnDOBase::init() {
+  for (int i = 0; i < n; i++) {
+    ch[i].limit = ULONG_MAX;
+    pinMode(ch[i].pin, OUTPUT);
+    digitalWrite(ch[i].pin, LOW);
+  }
+}
+
+/*!
+ * @brief Points the instance to its own storage after it was copied.
+ * @param channels Storage of the states of the pins, already copied from the original.
+**/
+void CgnDOBase::rebind(Channel *channels) {
+  ch = channels;
 }
 
 /*!
  * @brief Lowers down the pins that finished determined time length of output.
- * @return Difference between intended and actual output lengths in [ms].
+ * @return Difference between intended and actual output lengths in [ms] (or [us], see CgnClock).
  *         \c ULONG_MAX is returned when termination of output did not occur.
  * @note For a normal usage, this method is intended to be called
  *       once inside \c loop function.
 **/
-uint32_t CgnDO::update() {
-  uint32_t d = ULONG_MAX, cur = millis();
+uint32_t CgnDOBase::update() {
+  uint32_t d = ULONG_MAX, cur = cgnClock.raw(), done = 0;
+  // the scheduler may clear the deadline from its interrupt
+  byte s = CgnScheduler::lock();
   for (int i = 0; i < n; i++) {
-    if(cur >= limit[i]) {
-      digitalWrite(first + i, LOW);
-      d = cur - limit[i];
-      limit[i] = ULONG_MAX;
+    if (cgnClock.reached(ch[i].limit, cur)) {
+      done |= (uint32_t)1 << i;
+      d = cur - ch[i].limit;
+      ch[i].limit = ULONG_MAX;
     }
   }
+  if (done) {
+    write(done, false);
+  }
+  CgnScheduler::unlock(s);
   return d;
 }
 
 /*!
  * @brief Starts putting out from a pin for determined time length.
  * @param i Index of DO pin to emit digital output.
- * @param outputMs Time length of output in [ms].
+ * @param outputMs Time length of output in [ms] (or [us], see CgnClock).
+**/
+void CgnDOBase::out(byte i, uint32_t outputMs) {
+  byte s = CgnScheduler::lock();
+  write((uint32_t)1 << i, true);
+  ch[i].limit = cgnClock.after(outputMs);
+  CgnScheduler::post(next(), fire, this);
+  CgnScheduler::unlock(s);
+}
+
+/*!
+ * @brief Starts putting out from multiple pins together for determined time length.
+ * @param mask Bitmask of DO pins to emit digital output (\c i-th bit for \c i-th pin).
+ * @param outputMs Time length of output in [ms] (or [us], see CgnClock).
 **/
-void CgnDO::out(byte i, uint32_t outputMs) {
-  digitalWrite(first + i, HIGH);
-  limit[i] = millis() + outputMs;
+void CgnDOBase::outMask(uint32_t mask, uint32_t outputMs) {
+  mask &= all();
+  if (mask == 0) {
+    return;
+  }
+
+  byte s = CgnScheduler::lock();
+  write(mask, true);
+  uint32_t due = cgnClock.after(outputMs);
+  for (int i = 0; i < n; i++) {
+    if (mask & ((uint32_t)1 << i)) {
+      ch[i].limit = due;
+    }
+  }
+  CgnScheduler::post(next(), fire, this);
+  CgnScheduler::unlock(s);
 }
 
+/*!
+ * @brief Lowers down pins on behalf of CgnScheduler class.
+ * @param obj CgnDOBase instance that emitted the output.
+ * @return Whether any output was actually terminated.
+ * @note An instance keeps only its earliest deadline in the scheduler.
+ *       All the pins that have reached their deadlines are lowered down at once,
+ *       and the next earliest deadline is registered again.
+**/
+bool CgnDOBase::fire(void *obj, byte, uint32_t) {
+  CgnDOBase *self = (CgnDOBase *)obj;
+  uint32_t cur = cgnClock.raw(), done = 0;
+  for (int j = 0; j < self->n; j++) {
+    if (cgnClock.reached(self->ch[j].limit, cur)) {
+      done |= (uint32_t)1 << j;
+      self->ch[j].limit = ULONG_MAX;
+    }
+  }
+  if (done) {
+    self->write(done, false);
+  }
+  CgnScheduler::post(self->next(), fire, self);
+  return done != 0;
+}
+
+/*!
+ * @brief Shows the earliest deadline among the pins.
+ * @return Deadline in [ms] (or [us], see CgnClock).
+ *         \c ULONG_MAX is returned when no pin is on.
+**/
+uint32_t CgnDOBase::next() {
+  uint32_t t = ULONG_MAX;
+  for (int i = 0; i < n; i++) {
+    if (ch[i].limit != ULONG_MAX && (t == ULONG_MAX || cgnClock.earlier(ch[i].limit, t))) {
+      t = ch[i].limit;
+    }
+  }
+  return t;
+}
+
+/*!
+ * @brief Sets multiple pins to high or low voltage.
+ * @param mask Bitmask of DO pins to be written.
+ * @param high Whether to set the pins to high voltage.
+ * @note On AVR boards, each port register is written once
+ *       with interrupts blocked, so that the pins change together.
+**/
+void CgnDOBase::write(uint32_t mask, bool high) {
+#if defined(__AVR__)
+  // bits are gathered for each port
+  // (the ports and bits are looked up from the flash tables of the core,
+  // so that no storage is needed for each pin)
+  byte m[16];
+  uint16_t used = 0;
+  for (int i = 0; i < n; i++) {
+    if (mask & ((uint32_t)1 << i)) {
+      byte k = digitalPinToPort(ch[i].pin);
+      if (k == NOT_A_PIN || k >= 16) {
+        continue;
+      }
+      if (!(used & (1 << k))) {
+        used |= 1 << k;
+        m[k] = 0;
+      }
+      m[k] |= digitalPinToBitMask(ch[i].pin);
+    }
+  }
+  byte s = SREG;
+  cli();
+  for (byte k = 1; k < 16; k++) {
+    if (used & (1 << k)) {
+      volatile uint8_t *reg = portOutputRegister(k);
+      *reg = high ? (*reg | m[k]) : (*reg & ~m[k]);
+    }
+  }
+  SREG = s;
+#else
+  for (int i = 0; i < n; i++) {
+    if (mask & ((uint32_t)1 << i)) {
+      digitalWrite(ch[i].pin, high ? HIGH : LOW);
+    }
+  }
+#endif
+}
+
+/*!
+ * @brief Shows the bitmask covering all the pins in use.
+ * @return Bitmask with lowest @a n bits set.
+**/
+uint32_t CgnDOBase::all() {
+  return (n >= 32) ? ULONG_MAX : (((uint32_t)1 << n) - 1);
+}
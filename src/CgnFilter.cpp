@@ -0,0 +1,173 @@
+/*!
+ * @file CgnFilter.cpp
+ * @brief Definition of CgnFilter class.
+ * @author Kei Mochizuki
+ * @example Filter.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param filterKind Kind of the filter (\c CGN_IIR, \c CGN_MEAN, \c CGN_MEDIAN or \c CGN_CIC).
+ * @param param Parameter of the filter: the weight of a new sample as 1 / 2^param for \c CGN_IIR,
+ *        the number of samples for \c CGN_MEAN and \c CGN_MEDIAN (3 or 5),
+ *        and the decimation ratio for \c CGN_CIC.
+**/
+CgnFilter::CgnFilter(byte filterKind, byte param) {
+  kind = filterKind;
+  stamp = 0;
+  shift = BYTE_MAX;
+  switch (kind) {
+    case CGN_IIR:
+      len = 1;
+      shift = min(param, (byte)15);
+      break;
+    case CGN_MEAN:
+      len = constrain(param, 1, N_CGNFILTER);
+      break;
+    case CGN_MEDIAN:
+      len = (param >= 5) ? 5 : 3;
+      break;
+    default:
+      kind = CGN_CIC;
+      len = max(param, (byte)1);
+      break;
+  }
+  if (kind != CGN_IIR) {
+    // a power of 2 lets the output be scaled by a shift
+    for (byte b = 0; b < 8; b++) {
+      if (len == (1 << b)) {
+        shift = b;
+      }
+    }
+  }
+  reset();
+}
+
+/*!
+ * @brief Gives a sample to the filter.
+ * @param v Value of the sample.
+ * @return Whether a new output is available
+ *         (always \c true except for \c CGN_CIC, which gives one output per block).
+**/
+bool CgnFilter::put(int v) {
+  if (fresh) {
+    // the history is filled as if the first value had lasted forever
+    fresh = false;
+    if (kind == CGN_IIR) {
+      sum = (int32_t)v << shift;
+    } else {
+      uint16_t n = (kind == CGN_CIC) ? 2 * len : len;
+      for (uint16_t i = 1; i < n; i++) {
+        put(v);
+      }
+    }
+  }
+
+  switch (kind) {
+    case CGN_IIR:
+      sum += v - (sum >> shift);
+      out = sum >> shift;
+      return true;
+
+    case CGN_MEAN:
+      sum += v - hist[at];
+      hist[at] = v;
+      at = (at + 1 < len) ? at + 1 : 0;
+      out = (shift != BYTE_MAX) ? sum >> shift : sum / len;
+      return true;
+
+    case CGN_MEDIAN:
+      hist[at] = v;
+      at = (at + 1 < len) ? at + 1 : 0;
+      if (len == 3) {
+        out = median3(hist[0], hist[1], hist[2]);
+      } else {
+        // the middle two of the first four bound the median of five
+        int lo = max(min(hist[0], hist[1]), min(hist[2], hist[3]));
+        int hi = min(max(hist[0], hist[1]), max(hist[2], hist[3]));
+        out = median3(hist[4], lo, hi);
+      }
+      return true;
+
+    default:
+      // integrators and combs wrap around harmlessly in unsigned arithmetic
+      integ[0] += (uint32_t)(int32_t)v;
+      integ[1] += integ[0];
+      if (++phase < len) {
+        return false;
+      }
+      phase = 0;
+      uint32_t c1 = integ[1] - comb[0];
+      comb[0] = integ[1];
+      uint32_t c2 = c1 - comb[1];
+      comb[1] = c1;
+      if (shift != BYTE_MAX) {
+        out = (int32_t)c2 >> (2 * shift);
+      } else {
+        out = (int32_t)c2 / ((int32_t)len * len);
+      }
+      return true;
+  }
+}
+
+/*!
+ * @brief Gives a new sample of a channel of CgnAI to the filter.
+ * @param ai Analog input running the acquisition.
+ * @param ch Channel index.
+ * @return Whether a new output is available
+ *         (\c false also when no sample was taken since the last call).
+ * @note Only the latest sample is taken.
+ *       Samples are missed when the acquisition is faster than the calls.
+**/
+bool CgnFilter::update(CgnAI &ai, byte ch) {
+  int v = ai.get(ch);
+  uint32_t t = ai.when(ch);
+  if (!fresh && t == stamp) {
+    return false;
+  }
+  stamp = t;
+  return put(v);
+}
+
+/*!
+ * @brief Shows the latest output of the filter.
+ * @return Filtered value (in the unit of the samples).
+**/
+int CgnFilter::get() {
+  return out;
+}
+
+/*!
+ * @brief Forgets the history of the samples.
+ * @note The next sample fills the history again.
+**/
+void CgnFilter::reset() {
+  fresh = true;
+  out = 0;
+  at = 0;
+  phase = 0;
+  sum = 0;
+  for (int i = 0; i < N_CGNFILTER; i++) {
+    hist[i] = 0;
+  }
+  for (int i = 0; i < 2; i++) {
+    integ[i] = 0;
+    comb[i] = 0;
+  }
+}
+
+/*!
+ * @brief Takes the median of three values.
+ * @param a First value.
+ * @param b Second value.
+ * @param c Third value.
+ * @return Median of the values.
+**/
+int CgnFilter::median3(int a, int b, int c) {
+  int lo = min(a, b);
+  int hi = max(a, b);
+  return max(lo, min(hi, c));
+}
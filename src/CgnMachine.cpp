@@ -0,0 +1,129 @@
+/*!
+ * @file CgnMachine.cpp
+ * @brief Definition of CgnMachine class.
+ * @author Kei Mochizuki
+ * @example Machine.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param stageTable Time limitation of each state in flash memory
+ *                   (indexed by the state IDs).
+ * @param nStage Number of states in \a stageTable.
+ * @param ruleTable Input conditions in flash memory
+ *                  (grouped by their source states).
+ * @param nRule Number of conditions in \a ruleTable.
+ * @param stateNames Tab-separated names of the states in flash memory
+ *                   (in the order of their IDs; \c NULL to omit).
+**/
+CgnMachine::CgnMachine(const Stage *stageTable, byte nStage, const Rule *ruleTable, byte nRule, const __FlashStringHelper *stateNames) : CgnState(stateNames) {
+  stages = stageTable;
+  ns = nStage;
+  rules = ruleTable;
+  nr = nRule;
+  at = nr;
+  prev = 0;
+  nStep = 0;
+}
+
+/*!
+ * @brief Moves to a task state with the time limitation given in the table.
+ * @param newState ID of the new task state.
+**/
+void CgnMachine::set(byte newState) {
+  Stage g;
+  Rule r;
+  uint32_t ms = ULONG_MAX;
+
+  if (newState < ns) {
+    memcpy_P(&g, &stages[newState], sizeof(g));
+    ms = g.ms;
+  }
+  prev = get();
+  CgnState::set(newState, ms);
+  nStep++;
+
+  // locate the conditions of the new state only once on transition
+  at = 0;
+  while (at < nr) {
+    memcpy_P(&r, &rules[at], sizeof(r));
+    if (r.from == newState) {
+      break;
+    }
+    at++;
+  }
+}
+
+/*!
+ * @brief Evaluates the conditions of the current task state.
+ * @param di CgnDI instance whose inputs are referred by the conditions
+ *           (its \c update must have been called beforehand).
+ * @return Whether the task state changed.
+**/
+bool CgnMachine::step(CgnDIBase &di) {
+  byte s = get();
+  Rule r;
+  Stage g;
+
+  for (byte i = at; i < nr; i++) {
+    memcpy_P(&r, &rules[i], sizeof(r));
+    if (r.from != s) {
+      break;
+    }
+    if (test(di, r.ch, r.cond)) {
+      set(r.to);
+      return true;
+    }
+  }
+
+  if (s < ns && expire()) {
+    memcpy_P(&g, &stages[s], sizeof(g));
+    set(g.next);
+    return true;
+  }
+  return false;
+}
+
+/*!
+ * @brief Shows the previous task state.
+ * @return ID of the state before the last transition.
+**/
+byte CgnMachine::from() {
+  return prev;
+}
+
+/*!
+ * @brief Shows the number of transitions.
+ * @return Number of transitions since construction
+ *         (including the ones by \c set method).
+**/
+uint32_t CgnMachine::transitions() {
+  return nStep;
+}
+
+/*!
+ * @brief Tests an input condition.
+ * @param di CgnDI instance to be tested.
+ * @param ch Input channel.
+ * @param cond Kind of the condition (\c CGN_ON, \c CGN_TURNON etc.).
+ * @return Whether the condition is fulfilled.
+**/
+bool CgnMachine::test(CgnDIBase &di, byte ch, byte cond) {
+  switch (cond) {
+    case CGN_ON:
+      return di.on(ch);
+    case CGN_OFF:
+      return di.off(ch);
+    case CGN_TURNON:
+      return di.turnon(ch);
+    case CGN_TURNOFF:
+      return di.turnoff(ch);
+    case CGN_CHANGE:
+      return di.change(ch);
+    default:
+      return false;
+  }
+}
@@ -0,0 +1,249 @@
+/*!
+ * @file CgnPacket.cpp
+ * @brief Definition of CgnPacket class.
+ * @author Kei Mochizuki
+ * @example Packet.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param columnTypes Types of the columns in flash memory (e.g., F("HLBf")).
+ * @param columnNames Tab-separated names of the columns in flash memory
+ *        (e.g., F("trial\trt\tcorrect\tx")), or \c NULL if not needed.
+**/
+CgnPacket::CgnPacket(const __FlashStringHelper *columnTypes, const __FlashStringHelper *columnNames) {
+  types = (const char *)columnTypes;
+  names = (const char *)columnNames;
+  ncol = strlen_P(types);
+  nname = (names == NULL) ? 0 : strlen_P(names);
+  seq = 0;
+  clear();
+}
+
+/*!
+ * @brief Emits the schema descriptor of the records to serial output.
+ * @note Call this once in \c setup function (and whenever the host
+ *       may have missed it, e.g., after it reconnected).
+**/
+void CgnPacket::begin() {
+  frame(true, 3 + ncol + nname);
+}
+
+/*!
+ * @brief Appends a signed integer to the next column.
+ * @param newData Appended value (converted to the type of the column).
+ * @return Whether the value was appended (\c false when all the columns are filled).
+**/
+bool CgnPacket::append(int newData) {
+  return append((long)newData);
+}
+
+/*!
+ * @brief Appends an unsigned integer to the next column.
+ * @param newData Appended value (converted to the type of the column).
+ * @return Whether the value was appended (\c false when all the columns are filled).
+**/
+bool CgnPacket::append(unsigned int newData) {
+  return append((unsigned long)newData);
+}
+
+/*!
+ * @brief Appends a signed long integer to the next column.
+ * @param newData Appended value (converted to the type of the column).
+ * @return Whether the value was appended (\c false when all the columns are filled).
+**/
+bool CgnPacket::append(long newData) {
+  if (next() == 'f') {
+    return put((float)newData);
+  }
+  return put((uint32_t)newData);
+}
+
+/*!
+ * @brief Appends an unsigned long integer to the next column.
+ * @param newData Appended value (converted to the type of the column).
+ * @return Whether the value was appended (\c false when all the columns are filled).
+**/
+bool CgnPacket::append(unsigned long newData) {
+  if (next() == 'f') {
+    return put((float)newData);
+  }
+  return put((uint32_t)newData);
+}
+
+/*!
+ * @brief Appends a floating point value to the next column.
+ * @param newData Appended value (converted to the type of the column).
+ * @return Whether the value was appended (\c false when all the columns are filled).
+**/
+bool CgnPacket::append(double newData) {
+  if (next() == 'f') {
+    return put((float)newData);
+  }
+  return put((uint32_t)(long)newData);
+}
+
+/*!
+ * @brief Emits the record as a binary packet to serial output and clears it.
+ * @return Whether the record was emitted.
+ *         \c false is returned (and nothing is emitted) when the record
+ *         lacks some columns or has overflowed.
+**/
+bool CgnPacket::out() {
+  bool ok = !over && col == ncol;
+  if (ok) {
+    buf[1] = seq & 0xFF;
+    buf[2] = seq >> 8;
+    seq++;
+    frame(false, len);
+  }
+  clear();
+  return ok;
+}
+
+/*!
+ * @brief Clears the current record and its overflow flag.
+**/
+void CgnPacket::clear() {
+  buf[0] = 'R';
+  len = 3;
+  col = 0;
+  over = false;
+}
+
+/*!
+ * @brief Checks whether any of the appended data was rejected.
+ * @return Whether the record has overflowed since last \c out or \c clear.
+**/
+bool CgnPacket::overflow() {
+  return over;
+}
+
+/*!
+ * @brief Shows the type of the next column.
+ * @return Type character of the next column (\c 0 when all the columns are filled).
+**/
+char CgnPacket::next() {
+  return (col < ncol) ? pgm_read_byte(types + col) : 0;
+}
+
+/*!
+ * @brief Writes a value in little endian with the width of the next column.
+ * @param v Bit pattern of the value.
+ * @return Whether the value was written.
+**/
+bool CgnPacket::put(uint32_t v) {
+  byte w = width(next());
+  if (w == 0 || len + w > N_CGNPACKET) {
+    over = true;
+    return false;
+  }
+  for (byte i = 0; i < w; i++) {
+    buf[len++] = v & 0xFF;
+    v >>= 8;
+  }
+  col++;
+  return true;
+}
+
+/*!
+ * @brief Writes a floating point value in IEEE 754 single precision.
+ * @param v Written value.
+ * @return Whether the value was written.
+**/
+bool CgnPacket::put(float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, 4);
+  return put(bits);
+}
+
+/*!
+ * @brief Shows the width of a column type.
+ * @param type Type character of the column.
+ * @return Width in bytes (\c 0 for unknown type).
+**/
+byte CgnPacket::width(char type) {
+  switch (type) {
+    case 'b':
+    case 'B':
+      return 1;
+    case 'h':
+    case 'H':
+      return 2;
+    case 'l':
+    case 'L':
+    case 'f':
+      return 4;
+  }
+  return 0;
+}
+
+/*!
+ * @brief Shows a byte of the packet before COBS encoding.
+ * @param schema Whether the packet is the schema descriptor.
+ * @param i Position in the packet.
+ * @param n Length of the payload (followed by two bytes of CRC).
+ * @return Byte at the position.
+**/
+byte CgnPacket::peek(bool schema, uint16_t i, uint16_t n) {
+  if (i == n) {
+    return crc & 0xFF;
+  } else if (i == n + 1) {
+    return crc >> 8;
+  } else if (!schema) {
+    return buf[i];
+  } else if (i == 0) {
+    return 'S';
+  } else if (i == 1) {
+    return 1; // version of the protocol
+  } else if (i == 2) {
+    return ncol;
+  } else if (i < 3 + (uint16_t)ncol) {
+    return pgm_read_byte(types + i - 3);
+  }
+  return pgm_read_byte(names + i - 3 - ncol);
+}
+
+/*!
+ * @brief Emits a packet with CRC-16 in COBS framing.
+ * @param schema Whether the packet is the schema descriptor.
+ * @param n Length of the payload.
+ * @note The payload is followed by CRC-16/CCITT-FALSE in little endian,
+ *       encoded by Consistent Overhead Byte Stuffing,
+ *       and terminated by \c 0x00.
+**/
+void CgnPacket::frame(bool schema, uint16_t n) {
+  uint16_t i, j;
+
+  crc = 0xFFFF;
+  for (i = 0; i < n; i++) {
+    crc ^= (uint16_t)peek(schema, i, n) << 8;
+    for (byte k = 0; k < 8; k++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+
+  // each block is led by its length + 1, replacing the succeeding zero
+  i = 0;
+  while (true) {
+    j = i;
+    while (j < n + 2 && j - i < 254 && peek(schema, j, n) != 0) {
+      j++;
+    }
+    Serial.write((uint8_t)(j - i + 1));
+    for (uint16_t k = i; k < j; k++) {
+      Serial.write(peek(schema, k, n));
+    }
+    if (j - i == 254) {
+      i = j;
+    } else if (j >= n + 2) {
+      break;
+    } else {
+      i = j + 1;
+    }
+  }
+  Serial.write((uint8_t)0);
+}
@@ -19,15 +19,11 @@ CgnPeriod::CgnPeriod() {
 /*!
  * @brief Sets current task period and its time limitation.
  * @param newPeriod Name of the new task period.
- * @param lengthMs Maximum length of current task period in [ms].
+ * @param lengthMs Maximum length of current task period in [ms] (or [us], see CgnClock).
 **/
 void CgnPeriod::set(String newPeriod, uint32_t lengthMs) {
   period = newPeriod;
-  if (lengthMs > (ULONG_MAX - millis())) {
-    limit = ULONG_MAX;
-  } else {
-    limit = millis() + lengthMs;
-  }
+  limit = cgnClock.after(lengthMs);
 }
 
 /*!
@@ -44,7 +40,7 @@ bool CgnPeriod::is(String periodName) {
  * @return Whether time limitation of the current period has expired.
 **/
 bool CgnPeriod::expire() {
-  return millis() > limit;
+  return cgnClock.reached(limit);
 }
 
 /*!
@@ -57,7 +53,8 @@ String CgnPeriod::get() {
 
 /*!
  * @brief Shows the time limitation of the current task period.
- * @return Time limiation of the current period.
+ * @return Time limiation of the current period
+ *         (\c ULONG_MAX when the period lasts forever).
 **/
 uint32_t CgnPeriod::until() {
   return limit;
@@ -0,0 +1,239 @@
+/*!
+ * @file CgnProfiler.cpp
+ * @brief Definition of CgnProfiler class.
+ * @author Kei Mochizuki
+ * @example Profiler.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param budgetUs Target length of a loop in [us] (\b MICRO-seconds)
+ *                 (\c ULONG_MAX for no target).
+**/
+CgnProfiler::CgnProfiler(uint32_t budgetUs) {
+  budget = budgetUs;
+  start();
+}
+
+/*!
+ * @brief Start profiling by resetting the histogram.
+**/
+void CgnProfiler::start() {
+  for (int b = 0; b < N_CGNPROFILE; b++) {
+    hist[b] = 0;
+  }
+  n = 0;
+  sum = 0;
+  mx = 0;
+  mn = ULONG_MAX;
+  over = 0;
+  last = micros();
+}
+
+/*!
+ * @brief Records the length of the past loop.
+ * @return Length of the past loop in [us] (\b MICRO-seconds).
+ * @note For a normal usage, this method is intended to be called
+ *       once, and only once, inside \c loop function.
+**/
+uint32_t CgnProfiler::lap() {
+  uint32_t cur = micros();
+  uint32_t us = cur - last;
+  last = cur;
+  add(us);
+  return us;
+}
+
+/*!
+ * @brief Records an arbitrary duration (e.g., of a part of your \c loop).
+ * @param us Duration in [us] (\b MICRO-seconds).
+**/
+void CgnProfiler::add(uint32_t us) {
+  byte b = bin(us);
+  if (hist[b] == UINT16_MAX) {
+    // keep the shape of the distribution by halving all the bins
+    for (int i = 0; i < N_CGNPROFILE; i++) {
+      hist[i] >>= 1;
+    }
+  }
+  hist[b]++;
+  n++;
+  sum += us;
+  mx = max(mx, us);
+  mn = min(mn, us);
+  if (us > budget) {
+    over++;
+  }
+}
+
+/*!
+ * @brief Sets the target length of a loop.
+ * @param budgetUs Target length in [us] (\b MICRO-seconds)
+ *                 (\c ULONG_MAX for no target).
+**/
+void CgnProfiler::setBudget(uint32_t budgetUs) {
+  budget = budgetUs;
+}
+
+/*!
+ * @brief Shows a percentile of the recorded durations.
+ * @param p Percentage (\c 0 to \c 100).
+ * @return Upper bound of the histogram bin containing the percentile in [us]
+ *         (\c 0 when nothing is recorded).
+**/
+uint32_t CgnProfiler::percentile(byte p) {
+  uint32_t total = 0;
+  uint32_t need, acc;
+  for (int b = 0; b < N_CGNPROFILE; b++) {
+    total += hist[b];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  need = (total * min(p, (byte)100) + 99) / 100;
+  if (need == 0) {
+    need = 1;
+  }
+  acc = 0;
+  for (int b = 0; b < N_CGNPROFILE; b++) {
+    acc += hist[b];
+    if (acc >= need) {
+      return min(upper(b), mx);
+    }
+  }
+  return mx;
+}
+
+/*!
+ * @brief Shows the average of the recorded durations.
+ * @return Average duration in [us] (\b MICRO-seconds).
+**/
+uint32_t CgnProfiler::getMean() {
+  return (n == 0) ? 0 : (uint32_t)(sum / n);
+}
+
+/*!
+ * @brief Shows the maximal recorded duration.
+ * @return Maximal duration in [us] (\b MICRO-seconds).
+**/
+uint32_t CgnProfiler::getMax() {
+  return mx;
+}
+
+/*!
+ * @brief Shows the minimal recorded duration.
+ * @return Minimal duration in [us] (\b MICRO-seconds).
+**/
+uint32_t CgnProfiler::getMin() {
+  return mn;
+}
+
+/*!
+ * @brief Shows the number of durations exceeding the target.
+ * @return Number of overrun loops.
+**/
+uint32_t CgnProfiler::overrun() {
+  return over;
+}
+
+/*!
+ * @brief Shows the number of recorded durations.
+ * @return Number of laps (and \c add calls) since \c start.
+**/
+uint32_t CgnProfiler::count() {
+  return n;
+}
+
+/*!
+ * @brief Prints the summary to the Serial.
+ * @param withBins Whether to print non-empty bins of the histogram in the second line.
+ * @note The summary is a tab-separated line of count, mean, min,
+ *       50th, 95th and 99th percentile, max and overrun count.
+ *       The bins are printed as pairs of the lower bound [us] and the count.
+**/
+void CgnProfiler::out(bool withBins) {
+  Serial.print(n);
+  Serial.print('\t');
+  Serial.print(getMean());
+  Serial.print('\t');
+  Serial.print(n == 0 ? 0 : mn);
+  Serial.print('\t');
+  Serial.print(percentile(50));
+  Serial.print('\t');
+  Serial.print(percentile(95));
+  Serial.print('\t');
+  Serial.print(percentile(99));
+  Serial.print('\t');
+  Serial.print(mx);
+  Serial.print('\t');
+  Serial.println(over);
+
+  if (withBins) {
+    bool first = true;
+    for (int b = 0; b < N_CGNPROFILE; b++) {
+      if (hist[b] == 0) {
+        continue;
+      }
+      if (!first) {
+        Serial.print('\t');
+      }
+      Serial.print(lower(b));
+      Serial.print(':');
+      Serial.print(hist[b]);
+      first = false;
+    }
+    Serial.println();
+  }
+}
+
+/*!
+ * @brief Finds the histogram bin of a duration.
+ * @param us Duration in [us].
+ * @return Index of the bin.
+ * @note Durations below 8 us have their own bins,
+ *       and each octave above is divided into 4 bins.
+ *       Durations longer than the range are put in the last bin.
+**/
+byte CgnProfiler::bin(uint32_t us) {
+  byte k = 3;
+  byte b;
+  if (us < 8) {
+    return us;
+  }
+  while ((us >> (k + 1)) != 0) {
+    k++;
+  }
+  b = 8 + (k - 3) * 4 + ((us >> (k - 2)) & 3);
+  return min(b, (byte)(N_CGNPROFILE - 1));
+}
+
+/*!
+ * @brief Shows the lower bound of a histogram bin.
+ * @param b Index of the bin.
+ * @return Shortest duration in the bin in [us].
+**/
+uint32_t CgnProfiler::lower(byte b) {
+  if (b < 8) {
+    return b;
+  }
+  return (uint32_t)(4 + (b - 8) % 4) << (1 + (b - 8) / 4);
+}
+
+/*!
+ * @brief Shows the upper bound of a histogram bin.
+ * @param b Index of the bin.
+ * @return Longest duration in the bin in [us]
+ *         (\c ULONG_MAX for the last bin).
+**/
+uint32_t CgnProfiler::upper(byte b) {
+  if (b < 8) {
+    return b;
+  }
+  if (b == N_CGNPROFILE - 1) {
+    return ULONG_MAX;
+  }
+  return lower(b + 1) - 1;
+}
@@ -0,0 +1,262 @@
+/*!
+ * @file CgnRecord.cpp
+ * @brief Definition of CgnRecordBase class.
+ * @author Kei Mochizuki
+ * @example Record.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param buffer Storage of the record (at least @a size + 1 bytes).
+ * @param size Maximal length of the record in characters.
+ * @param separatingChar Separator for serial outputs (by default @\t).
+**/
+CgnRecordBase::CgnRecordBase(char *buffer, uint16_t size, char separatingChar) {
+  buf = buffer;
+  cap = size;
+  sep = separatingChar;
+  clear();
+}
+
+/*!
+ * @brief Points the record to its own buffer after it was copied.
+ * @param buffer Buffer already holding the copied text.
+**/
+void CgnRecordBase::rebind(char *buffer) {
+  buf = buffer;
+}
+
+/*!
+ * @brief Appends a text to the record.
+ * @param newData Appended text.
+ * @return Whether the text was appended (\c false on overflow).
+**/
+bool CgnRecordBase::append(const char *newData) {
+  uint16_t mark = len;
+  bool ok = put(sep);
+  while (ok && *newData != '\0') {
+    ok = put(*newData++);
+  }
+  return settle(mark, ok);
+}
+
+/*!
+ * @brief Appends a text stored in flash memory (e.g., F("text")) to the record.
+ * @param newData Appended text.
+ * @return Whether the text was appended (\c false on overflow).
+**/
+bool CgnRecordBase::append(const __FlashStringHelper *newData) {
+  const char *p = (const char *)newData;
+  uint16_t mark = len;
+  bool ok = put(sep);
+  char c;
+  while (ok && (c = pgm_read_byte(p++)) != '\0') {
+    ok = put(c);
+  }
+  return settle(mark, ok);
+}
+
+/*!
+ * @brief Appends a character to the record.
+ * @param newData Appended character.
+ * @return Whether the character was appended (\c false on overflow).
+**/
+bool CgnRecordBase::append(char newData) {
+  uint16_t mark = len;
+  bool ok = put(sep) && put(newData);
+  return settle(mark, ok);
+}
+
+/*!
+ * @brief Appends a signed integer in decimal to the record.
+ * @param newData Appended value.
+ * @return Whether the value was appended (\c false on overflow).
+**/
+bool CgnRecordBase::append(int newData) {
+  return append((long)newData);
+}
+
+/*!
+ * @brief Appends an unsigned integer in decimal to the record.
+ * @param newData Appended value.
+ * @return Whether the value was appended (\c false on overflow).
+**/
+bool CgnRecordBase::append(unsigned int newData) {
+  return append((unsigned long)newData);
+}
+
+/*!
+ * @brief Appends a signed long integer in decimal to the record.
+ * @param newData Appended value.
+ * @return Whether the value was appended (\c false on overflow).
+**/
+bool CgnRecordBase::append(long newData) {
+  uint16_t mark = len;
+  bool ok = put(sep);
+  if (newData < 0) {
+    ok = ok && put('-');
+    ok = ok && digits(0UL - (unsigned long)newData);
+  } else {
+    ok = ok && digits(newData);
+  }
+  return settle(mark, ok);
+}
+
+/*!
+ * @brief Appends an unsigned long integer in decimal to the record.
+ * @param newData Appended value.
+ * @return Whether the value was appended (\c false on overflow).
+**/
+bool CgnRecordBase::append(unsigned long newData) {
+  uint16_t mark = len;
+  bool ok = put(sep) && digits(newData);
+  return settle(mark, ok);
+}
+
+/*!
+ * @brief Appends a floating point value in decimal to the record.
+ * @param newData Appended value.
+ * @param fractionDigits Number of digits after the decimal point.
+ * @return Whether the value was appended (\c false on overflow).
+ * @note Same as \c Serial.print, "nan", "inf" or "ovf" is appended
+ *       for values that cannot be represented.
+**/
+bool CgnRecordBase::append(double newData, byte fractionDigits) {
+  uint16_t mark = len;
+  unsigned long whole;
+  double rounding = 0.5;
+  bool ok = put(sep);
+
+  if (isnan(newData)) {
+    ok = ok && put('n') && put('a') && put('n');
+    return settle(mark, ok);
+  }
+  if (isinf(newData)) {
+    ok = ok && put('i') && put('n') && put('f');
+    return settle(mark, ok);
+  }
+  if (newData > 4294967040.0 || newData < -4294967040.0) {
+    ok = ok && put('o') && put('v') && put('f');
+    return settle(mark, ok);
+  }
+
+  if (newData < 0.0) {
+    ok = ok && put('-');
+    newData = -newData;
+  }
+  for (byte i = 0; i < fractionDigits; i++) {
+    rounding /= 10.0;
+  }
+  newData += rounding;
+
+  whole = (unsigned long)newData;
+  newData -= (double)whole;
+  ok = ok && digits(whole);
+  if (fractionDigits > 0) {
+    ok = ok && put('.');
+  }
+  while (ok && fractionDigits-- > 0) {
+    newData *= 10.0;
+    byte d = (byte)newData;
+    ok = put('0' + d);
+    newData -= d;
+  }
+  return settle(mark, ok);
+}
+
+/*!
+ * @brief Emits the record to serial output and clears it.
+**/
+void CgnRecordBase::out() {
+  Serial.write((const uint8_t *)buf, len);
+  Serial.println();
+  clear();
+}
+
+/*!
+ * @brief Clears the record and its overflow flag.
+**/
+void CgnRecordBase::clear() {
+  len = 0;
+  buf[0] = '\0';
+  over = false;
+}
+
+/*!
+ * @brief Checks whether any of the appended data was rejected for the lack of space.
+ * @return Whether the record has overflowed since last \c out or \c clear.
+**/
+bool CgnRecordBase::overflow() {
+  return over;
+}
+
+/*!
+ * @brief Shows the current record.
+ * @return Null-terminated text of the record.
+**/
+const char *CgnRecordBase::get() {
+  return buf;
+}
+
+/*!
+ * @brief Shows the length of the current record.
+ * @return Number of characters in the record.
+**/
+uint16_t CgnRecordBase::length() {
+  return len;
+}
+
+/*!
+ * @brief Writes a character at the end of the record.
+ * @param c Written character.
+ * @return Whether there was a room for the character.
+**/
+bool CgnRecordBase::put(char c) {
+  if (len >= cap) {
+    return false;
+  }
+  buf[len++] = c;
+  return true;
+}
+
+/*!
+ * @brief Writes an unsigned value in decimal at the end of the record.
+ * @param v Written value.
+ * @return Whether there was a room for the digits.
+**/
+bool CgnRecordBase::digits(unsigned long v) {
+  uint16_t from = len;
+  char c;
+  do {
+    if (!put('0' + v % 10)) {
+      return false;
+    }
+    v /= 10;
+  } while (v > 0);
+
+  // digits were written from the lowest, so reverse them in place
+  for (uint16_t i = from, j = len - 1; i < j; i++, j--) {
+    c = buf[i];
+    buf[i] = buf[j];
+    buf[j] = c;
+  }
+  return true;
+}
+
+/*!
+ * @brief Terminates the record, or rolls back a partially appended field.
+ * @param mark Length of the record before the field was appended.
+ * @param ok Whether the field was fully appended.
+ * @return Same as \a ok.
+**/
+bool CgnRecordBase::settle(uint16_t mark, bool ok) {
+  if (!ok) {
+    len = mark;
+    over = true;
+  }
+  buf[len] = '\0';
+  return ok;
+}
@@ -0,0 +1,281 @@
+/*!
+ * @file CgnScheduler.cpp
+ * @brief Definition of CgnScheduler class.
+ * @author Kei Mochizuki
+ * @example Scheduler.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+CGN_LOCAL CgnScheduler cgnScheduler;
+CGN_LOCAL CgnScheduler *CgnScheduler::current = NULL;
+CGN_LOCAL bool CgnScheduler::viaIsr = false;
+
+/*!
+ * @brief Starts servicing deadlines of output classes.
+ * @param isr Whether to service deadlines in a hardware timer interrupt.
+ * @return Whether deadlines are serviced in a hardware timer interrupt.
+ *         \c false is returned when \a isr is \c false
+ *         or the board does not support timer interrupt servicing,
+ *         in which case you need to call \c update method in your \c loop.
+ * @note Once started, all the outputs emitted by CgnDO, CgnAO, CgnTone,
+ *       CgnTimerDO and CgnTimerAO classes are registered to this scheduler.
+**/
+bool CgnScheduler::begin(bool isr) {
+  byte s = lock();
+  n = 0;
+  nFired = 0;
+  worst = ULONG_MAX;
+  mx = 0;
+  current = this;
+  viaIsr = isr && CgnClock::attach(hook, this);
+  unlock(s);
+  return viaIsr;
+}
+
+/*!
+ * @brief Stops servicing deadlines and discards registered ones.
+ * @note Pending outputs are still terminated by \c update methods
+ *       of each output class.
+**/
+void CgnScheduler::end() {
+  byte s = lock();
+  CgnClock::detach(hook, this);
+  if (current == this) {
+    current = NULL;
+    viaIsr = false;
+  }
+  n = 0;
+  unlock(s);
+}
+
+/*!
+ * @brief Registers a deadline to the running scheduler, if any.
+ * @param due Deadline computed by \c CgnClock::after.
+ * @param fire Function that performs the action.
+ *        It should return \c false when the deadline is no longer valid.
+ * @param obj Object passed to \a fire.
+ * @param ch Channel index passed to \a fire.
+ * @return Whether the deadline was registered.
+ *         \c false is returned when no scheduler is running
+ *         or the scheduler is full (i.e., \c N_CGNSCHEDULE deadlines are pending),
+ *         as well as for the deadline that never comes (\c ULONG_MAX).
+ * @note Each pair of \a obj and \a ch holds at most one deadline.
+ *       A deadline posted again for the same pair replaces the previous one,
+ *       and \c ULONG_MAX just withdraws it.
+ *       When the scheduler is serviced in timer interrupt,
+ *       the caller should hold \c lock while it updates its own deadline
+ *       and calls this method.
+**/
+bool CgnScheduler::post(uint32_t due, bool (*fire)(void *, byte, uint32_t), void *obj, byte ch) {
+  CgnScheduler *s = current;
+  byte i, p;
+  if (s == NULL) {
+    return false;
+  }
+
+  // drop the deadline that this one supersedes
+  for (i = 0; i < s->n; i++) {
+    if (s->heap[i].obj == obj && s->heap[i].ch == ch && s->heap[i].fire == fire) {
+      s->remove(i);
+      break;
+    }
+  }
+  if (s->n >= N_CGNSCHEDULE || due == ULONG_MAX) {
+    return false;
+  }
+
+  // sift up from the tail of the heap
+  i = s->n;
+  s->n++;
+  while (i > 0) {
+    p = (i - 1) / 2;
+    if (!earlier(due, s->heap[p].due)) {
+      break;
+    }
+    s->heap[i] = s->heap[p];
+    i = p;
+  }
+  s->heap[i].due = due;
+  s->heap[i].fire = fire;
+  s->heap[i].obj = obj;
+  s->heap[i].ch = ch;
+  return true;
+}
+
+/*!
+ * @brief Blocks the timer interrupt servicing the deadlines.
+ * @return State to be passed to \c unlock.
+ * @note This does nothing unless the scheduler is serviced in timer interrupt.
+**/
+byte CgnScheduler::lock() {
+#if defined(__AVR__)
+  byte s = SREG;
+  if (viaIsr) {
+    cli();
+  }
+  return s;
+#else
+  return 0;
+#endif
+}
+
+/*!
+ * @brief Restores the state saved by \c lock.
+ * @param s State returned by \c lock.
+**/
+void CgnScheduler::unlock(byte s) {
+#if defined(__AVR__)
+  SREG = s;
+#else
+  (void)s;
+#endif
+}
+
+/*!
+ * @brief Performs the actions whose deadlines have been reached.
+ * @return Maximal difference between intended and actual action timing
+ *         among the performed actions in [ms] (or [us], see CgnClock).
+ *         \c ULONG_MAX is returned when no action occured.
+ * @note For a normal usage, this method is intended to be called
+ *       once inside \c loop function.
+ *       Only the expired deadlines are examined, so the cost does not
+ *       depend on the number of registered outputs.
+ *       When the scheduler is serviced in timer interrupt,
+ *       this method only reports the actions performed
+ *       since the last call.
+**/
+uint32_t CgnScheduler::update() {
+  uint32_t d;
+  byte s = lock();
+  if (!viaIsr) {
+    nFired = 0;
+    worst = ULONG_MAX;
+    service();
+  }
+  d = worst;
+  fires = nFired;
+  nFired = 0;
+  worst = ULONG_MAX;
+  unlock(s);
+  return d;
+}
+
+/*!
+ * @brief Shows the number of actions performed by the last \c update.
+ * @return Number of performed actions.
+**/
+byte CgnScheduler::fired() {
+  return fires;
+}
+
+/*!
+ * @brief Shows the number of deadlines currently registered.
+ * @return Number of pending deadlines.
+**/
+byte CgnScheduler::pending() {
+  return n;
+}
+
+/*!
+ * @brief Shows maximal lateness of actions since \c begin.
+ * @return Maximal difference between intended and actual action timing in [ms] (or [us], see CgnClock).
+**/
+uint32_t CgnScheduler::getMax() {
+  return mx;
+}
+
+/*!
+ * @brief Shows the earliest registered deadline.
+ * @return Time of the earliest deadline in [ms] (or [us], see CgnClock).
+ *         \c ULONG_MAX is returned when no deadline is registered.
+**/
+uint32_t CgnScheduler::until() {
+  uint32_t t;
+  byte s = lock();
+  t = (n > 0) ? heap[0].due : ULONG_MAX;
+  unlock(s);
+  return t;
+}
+
+/*!
+ * @brief Services the deadlines from timer interrupt.
+ * @param obj CgnScheduler instance to be serviced.
+**/
+void CgnScheduler::hook(void *obj) {
+  ((CgnScheduler *)obj)->service();
+}
+
+/*!
+ * @brief Performs the expired actions and accumulates their lateness.
+**/
+void CgnScheduler::service() {
+  uint32_t cur = CgnClock::raw(), late;
+  Entry e;
+
+  while (n > 0 && !earlier(cur, heap[0].due)) {
+    e = heap[0];
+    remove(0);
+    if (e.fire(e.obj, e.ch, e.due)) {
+      late = cur - e.due;
+      if (nFired < BYTE_MAX) {
+        nFired++;
+      }
+      mx = max(mx, late);
+      if (worst == ULONG_MAX || late > worst) {
+        worst = late;
+      }
+    }
+  }
+}
+
+/*!
+ * @brief Removes a deadline from the heap.
+ * @param at Position of the deadline in the heap (\c 0 for the earliest one).
+**/
+void CgnScheduler::remove(byte at) {
+  byte i = at, c, p;
+  Entry last;
+
+  n--;
+  if (at == n) {
+    return;
+  }
+  last = heap[n];
+
+  // the last entry may belong either above or below the vacancy
+  while (i > 0) {
+    p = (i - 1) / 2;
+    if (!earlier(last.due, heap[p].due)) {
+      break;
+    }
+    heap[i] = heap[p];
+    i = p;
+  }
+  while (true) {
+    c = 2 * i + 1;
+    if (c >= n) {
+      break;
+    }
+    if (c + 1 < n && earlier(heap[c + 1].due, heap[c].due)) {
+      c++;
+    }
+    if (!earlier(heap[c].due, last.due)) {
+      break;
+    }
+    heap[i] = heap[c];
+    i = c;
+  }
+  heap[i] = last;
+}
+
+/*!
+ * @brief Compares two deadlines.
+ * @param a First deadline.
+ * @param b Second deadline.
+ * @return Whether \a a comes before \a b.
+**/
+bool CgnScheduler::earlier(uint32_t a, uint32_t b) {
+  return CgnClock::earlier(a, b);
+}
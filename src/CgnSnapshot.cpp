@@ -0,0 +1,213 @@
+/*!
+ * @file CgnSnapshot.cpp
+ * @brief Definition of CgnSnapshotBase class.
+ * @author Kei Mochizuki
+ * @example Snapshot.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param buffer Storage of the samples (at least @a size values).
+ * @param size Number of values kept in @a buffer.
+ * @param analogIn CgnAI instance sampling the signals.
+ * @param digitalIn CgnDI instance giving the trigger.
+ * @param triggerInput Index of the triggering input of @a digitalIn.
+ * @param triggerEdge Edge of the input (\c CGN_TURNON, \c CGN_TURNOFF or \c CGN_CHANGE).
+ * @param preMs Length of the window before the edge in [ms].
+ * @param postMs Length of the window after the edge in [ms].
+ * @param channels Bitmask of the recorded channels of @a analogIn.
+**/
+CgnSnapshotBase::CgnSnapshotBase(int *buffer, uint16_t size, CgnAI &analogIn, CgnDIBase &digitalIn,
+                                 byte triggerInput, byte triggerEdge,
+                                 uint16_t preMs, uint16_t postMs, byte channels) {
+  ai = &analogIn;
+  di = &digitalIn;
+  input = triggerInput;
+  edge = triggerEdge;
+  pre = (uint32_t)preMs * 1000;
+  post = (uint32_t)postMs * 1000;
+  mask = (channels == 0) ? 1 : channels;
+  k = 0;
+  lead = BYTE_MAX;
+  for (byte c = 0; c < 8; c++) {
+    if (mask & (1 << c)) {
+      k++;
+      lead = min(lead, c);
+    }
+  }
+  buf = buffer;
+  cap = size / k;
+  arm();
+}
+
+/*!
+ * @brief Points the instance to its own buffer after it was copied.
+ * @param buffer Buffer already holding the copied samples.
+**/
+void CgnSnapshotBase::rebind(int *buffer) {
+  buf = buffer;
+}
+
+/*!
+ * @brief Takes the samples of CgnAI and watches the trigger.
+ * @return Whether a snapshot has just been completed.
+ * @note For a normal usage, this method is intended to be called
+ *       once inside \c loop function, after \c update of CgnDI.
+**/
+bool CgnSnapshotBase::update() {
+  byte ch;
+  uint32_t t;
+  int v;
+
+  while ((v = ai->read(&ch, &t)) >= 0) {
+    store(v, ch, t);
+  }
+
+  if (phase == 0 && triggered()) {
+    // locate the edge among the frames by the time stamps
+    trig = di->when(input);
+    phase = 1;
+    if (frames == 0 || (int32_t)(trig - tLast) > 0) {
+      trigFrame = frames;
+    } else {
+      trigFrame = (int32_t)(frames - 1) - (int32_t)((tLast - trig) / interval());
+    }
+  }
+
+  if (phase == 1 && frames > 0 && (int32_t)(tLast - trig) >= (int32_t)post) {
+    int32_t oldest = (frames >= cap) ? frames - cap + 1 : 0;
+    int32_t first = trigFrame - (int32_t)(pre / interval());
+    from = max(first, oldest);
+    to = (pos >= k) ? frames : frames - 1;
+    cursor = from;
+    phase = 2;
+    return true;
+  }
+  return false;
+}
+
+/*!
+ * @brief Checks whether a snapshot is frozen and waiting for output.
+ * @return Result of the examined state.
+**/
+bool CgnSnapshotBase::ready() {
+  return phase >= 2;
+}
+
+/*!
+ * @brief Emits a row of the frozen snapshot through CgnData.
+ * @param data CgnData instance used for the output (with no item appended).
+ * @param perRow Number of frames (i.e., samples of all the recorded channels) in a row.
+ * @return Whether a row was emitted. \c false when no snapshot is frozen,
+ *         or when all the rows have been emitted (then recording restarts).
+**/
+bool CgnSnapshotBase::out(CgnData &data, byte perRow) {
+  if (phase < 2) {
+    return false;
+  }
+  if (phase == 2) {
+    data.append(String(trig));
+    data.append(String(interval()));
+    data.append(String((long)(trigFrame - (int32_t)from)));
+    data.append(String(to - from));
+    data.out();
+    phase = 3;
+    return true;
+  }
+  if (cursor >= to) {
+    arm();
+    return false;
+  }
+
+  data.append(String((long)((int32_t)cursor - trigFrame)));
+  for (byte i = 0; i < max(perRow, (byte)1) && cursor < to; i++) {
+    int *frame = buf + (cursor % cap) * k;
+    for (byte j = 0; j < k; j++) {
+      data.append(String(frame[j]));
+    }
+    cursor++;
+  }
+  data.out();
+  return true;
+}
+
+/*!
+ * @brief Discards the snapshot and restarts recording for the next edge.
+**/
+void CgnSnapshotBase::arm() {
+  phase = 0;
+  pos = k;
+  frames = 0;
+  tFirst = 0;
+  tLast = 0;
+  trig = 0;
+  trigFrame = 0;
+  from = 0;
+  to = 0;
+  cursor = 0;
+}
+
+/*!
+ * @brief Shows the time of the last triggering edge.
+ * @return Time of the edge in [us] (i.e., in the unit of \c micros).
+**/
+uint32_t CgnSnapshotBase::when() {
+  return trig;
+}
+
+/*!
+ * @brief Shows the interval of frames measured from their time stamps.
+ * @return Mean interval of the frames recorded since the last restart in [us]
+ *         (\c 1 until two frames are recorded).
+**/
+uint32_t CgnSnapshotBase::interval() {
+  if (frames < 2 || tLast == tFirst) {
+    return 1;
+  }
+  return (tLast - tFirst) / (frames - 1);
+}
+
+/*!
+ * @brief Stores a sample into the circular buffer.
+ * @param v Value of the sample.
+ * @param ch Channel index of the sample.
+ * @param t Time of the sample in [us].
+ * @note A frame begins with the lowest recorded channel.
+**/
+void CgnSnapshotBase::store(int v, byte ch, uint32_t t) {
+  if (phase >= 2 || cap == 0 || ch >= 8 || !(mask & (1 << ch))) {
+    return;
+  }
+  if (ch == lead) {
+    if (frames == 0) {
+      tFirst = t;
+    }
+    tLast = t;
+    frames++;
+    pos = 0;
+  }
+  if (pos >= k) {
+    return;
+  }
+  buf[((frames - 1) % cap) * k + pos] = v;
+  pos++;
+}
+
+/*!
+ * @brief Checks the triggering edge of CgnDI.
+ * @return Whether the edge occured in current loop.
+**/
+bool CgnSnapshotBase::triggered() {
+  switch (edge) {
+    case CGN_TURNON:
+      return di->turnon(input);
+    case CGN_TURNOFF:
+      return di->turnoff(input);
+    case CGN_CHANGE:
+      return di->change(input);
+  }
+  return false;
+}
@@ -0,0 +1,132 @@
+/*!
+ * @file CgnState.cpp
+ * @brief Definition of CgnState class.
+ * @author Kei Mochizuki
+ * @example State.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param stateNames Tab-separated names of the states in flash memory
+ *                   (in the order of their IDs; \c NULL to omit).
+**/
+CgnState::CgnState(const __FlashStringHelper *stateNames) {
+  names = (const char *)stateNames;
+  state = 0;
+  from = cgnClock.raw();
+  limit = ULONG_MAX;
+}
+
+/*!
+ * @brief Sets current task state and its time limitation.
+ * @param newState ID of the new task state.
+ * @param lengthMs Maximum length of current task state in [ms] (or [us], see CgnClock).
+**/
+void CgnState::set(byte newState, uint32_t lengthMs) {
+  state = newState;
+  from = cgnClock.raw();
+  limit = cgnClock.after(lengthMs);
+}
+
+/*!
+ * @brief Checks whether the current task state is \a s.
+ * @param s ID of the candidate task state.
+ * @return Whether the current state matches the designated one.
+**/
+bool CgnState::is(byte s) {
+  return state == s;
+}
+
+/*!
+ * @brief Checks whether the current task state expired its time limitation.
+ * @return Whether time limitation of the current state has expired.
+**/
+bool CgnState::expire() {
+  return cgnClock.reached(limit);
+}
+
+/*!
+ * @brief Shows current task state.
+ * @return ID of the current state.
+**/
+byte CgnState::get() {
+  return state;
+}
+
+/*!
+ * @brief Shows the name of current task state.
+ * @return Name of the current state
+ *         (empty when no name is given for the state).
+ * @note This method allocates a String. Use \c printName for heap-free logging.
+**/
+String CgnState::getName() {
+  String s = "";
+  const char *p = name();
+  char c;
+  while (p != NULL && (c = pgm_read_byte(p)) != '\0' && c != '\t') {
+    s += c;
+    p++;
+  }
+  return s;
+}
+
+/*!
+ * @brief Prints the name of current task state.
+ * @param out Destination of printing (e.g., \c Serial).
+ * @return Number of printed characters.
+**/
+size_t CgnState::printName(Print &out) {
+  size_t n = 0;
+  const char *p = name();
+  char c;
+  while (p != NULL && (c = pgm_read_byte(p)) != '\0' && c != '\t') {
+    n += out.write(c);
+    p++;
+  }
+  return n;
+}
+
+/*!
+ * @brief Shows the time when the current task state began.
+ * @return Time of the last \c set in [ms] (or [us], see CgnClock).
+**/
+uint32_t CgnState::since() {
+  return from;
+}
+
+/*!
+ * @brief Shows the time limitation of the current task state.
+ * @return Time limiation of the current state
+ *         (\c ULONG_MAX when the state lasts forever).
+**/
+uint32_t CgnState::until() {
+  return limit;
+}
+
+/*!
+ * @brief Locates the name of current task state.
+ * @return Pointer to the head of the name in flash memory
+ *         (\c NULL when no name is given for the state).
+**/
+const char *CgnState::name() {
+  const char *p = names;
+  byte i = 0;
+  char c;
+  if (p == NULL) {
+    return NULL;
+  }
+  while (i < state) {
+    c = pgm_read_byte(p);
+    if (c == '\0') {
+      return NULL;
+    }
+    if (c == '\t') {
+      i++;
+    }
+    p++;
+  }
+  return p;
+}
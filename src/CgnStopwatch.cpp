@@ -15,26 +15,27 @@
  * @brief Constructor.
 **/
 CgnStopwatch::CgnStopwatch() {
-  from = millis();
+  from = cgnClock.now();
 }
 
 /*!
- * @brief Shows elapsed time in [ms] and resart the clock.
- * @return Time past from last \c lap in [ms].
+ * @brief Shows elapsed time and resart the clock.
+ * @return Time past from last \c lap in [ms] (or [us], see CgnClock).
 **/
 uint32_t CgnStopwatch::lap() {
-  uint32_t tmp;
-  tmp = millis() - from;
-  from = millis();
+  uint32_t cur, tmp;
+  cur = cgnClock.now();
+  tmp = cur - from;
+  from = cur;
   return tmp;
 }
 
 /*!
- * @brief Shows elapsed time in [ms] without resarting the clock.
- * @return Time past from last \c lap in [ms].
+ * @brief Shows elapsed time without resarting the clock.
+ * @return Time past from last \c lap in [ms] (or [us], see CgnClock).
 **/
 uint32_t CgnStopwatch::get() {
-  return millis() - from;
+  return cgnClock.now() - from;
 }
 
 
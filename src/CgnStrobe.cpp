@@ -24,6 +24,17 @@ CgnStrobe::CgnStrobe(byte firstPin, uint32_t strobeUs, bool sendTerminator) {
     len = strobeUs;
     us = true;
   }
+  ticks = us ? (len + 999) / 1000 : len;
+  if (ticks == 0) {
+    ticks = 1;
+  }
+  queued = false;
+  head = 0;
+  tail = 0;
+  lost = 0;
+  phase = 0;
+  rest = 0;
+  ported = false;
 
   for (int i = 0; i < 9; i++) {
     pinMode(first + i, OUTPUT);
@@ -31,44 +42,241 @@ CgnStrobe::CgnStrobe(byte firstPin, uint32_t strobeUs, bool sendTerminator) {
   }
 }
 
+/*!
+ * @brief Switches data pins to single-store parallel output.
+ * @param enable Whether to write data pins via port register.
+ * @return Whether parallel output is actually in use.
+ *         \c false is returned when the 8 data pins do not form
+ *         one whole hardware port in ascending or descending order,
+ *         or on non-AVR boards.
+**/
+bool CgnStrobe::parallel(bool enable) {
+  ported = false;
+#if defined(__AVR__)
+  if (enable) {
+    byte port = digitalPinToPort(first);
+    bool up = true;
+    bool down = true;
+    for (int j = 0; j < 8; j++) {
+      if (digitalPinToPort(first + j) != port) {
+        return false;
+      }
+      up = up && digitalPinToBitMask(first + j) == _BV(j);
+      down = down && digitalPinToBitMask(first + j) == _BV(7 - j);
+    }
+    if (port == NOT_A_PIN || digitalPinToPort(first + 8) == NOT_A_PIN ||
+        !(up || down)) {
+      return false;
+    }
+    dataReg = portOutputRegister(port);
+    strobeReg = portOutputRegister(digitalPinToPort(first + 8));
+    strobeBit = digitalPinToBitMask(first + 8);
+    flip = !up;
+    ported = true;
+  }
+#else
+  (void)enable;
+#endif
+  return ported;
+}
+
+/*!
+ * @brief Switches strobing to background operation in timer interrupt.
+ * @param enable Whether to strobe in background.
+ * @return Whether background strobing is actually in use.
+ *         \c false is returned on boards without the timer interrupt
+ *         of CgnClock class.
+ * @note In background operation, each strobe phase lasts
+ *       a whole number of interrupt cycles (~1 ms).
+**/
+bool CgnStrobe::async(bool enable) {
+  if (enable) {
+    queued = CgnClock::attach(hook, this);
+  } else {
+    while (busy()) {
+      delay(1);
+    }
+    CgnClock::detach(hook, this);
+    queued = false;
+  }
+  return queued;
+}
+
 /*!
  * @brief Emits arbitrary text by (8 + 1)-bit digital outputs.
  * @param txt Text to be put out.
  * @return Time spent by strobing in [ms].
+ *         In background operation, \c 0 is returned when the text was queued,
+ *         and \c ULONG_MAX when the queue had no room for the whole text.
 **/
 uint32_t CgnStrobe::out(String txt) {
-  bool tmp;
-  byte n = txt.length();
+  return out(txt.c_str());
+}
+
+/*!
+ * @brief Emits arbitrary text by (8 + 1)-bit digital outputs.
+ * @param txt Null-terminated text to be put out.
+ * @return Time spent by strobing in [ms].
+ *         In background operation, \c 0 is returned when the text was queued,
+ *         and \c ULONG_MAX when the queue had no room for the whole text.
+**/
+uint32_t CgnStrobe::out(const char *txt) {
+  byte n = strlen(txt);
   uint32_t from = millis();
 
+  if (queued) {
+    return enqueue(txt, n) ? 0 : ULONG_MAX;
+  }
+
   for (int i = 0; i < n; i++) {
     //Serial.print(s.charAt(i));
     //Serial.print(" ");
 
-    for (int j = 7; j >= 0; j--) {
-      tmp = (byte(txt.charAt(i)) & _BV(j)) > 0;
-      digitalWrite(first + j, tmp ? HIGH : LOW);
-      //Serial.print(tmp);
-    }
-    digitalWrite(first + 8, HIGH);
+    put(txt[i]);
+    strobe(HIGH);
     //Serial.println("");
     wait();
-    digitalWrite(first + 8, LOW);
+    strobe(LOW);
     wait();
   }
 
-  for (int j = 7; j >= 0; j--) {
-    digitalWrite(first + j, LOW);
-  }
+  put(0);
   if (term) {
-    digitalWrite(first + 8, HIGH);
+    strobe(HIGH);
     wait();
-    digitalWrite(first + 8, LOW);
+    strobe(LOW);
   }
 
   return millis() - from;
 }
 
+/*!
+ * @brief Checks whether background strobing is in progress.
+ * @return Whether any character is queued or being strobed.
+**/
+bool CgnStrobe::busy() {
+  return phase != 0 || head != tail;
+}
+
+/*!
+ * @brief Shows the number of characters waiting in the queue.
+ * @return Number of queued characters (not including the one being strobed).
+**/
+byte CgnStrobe::pending() {
+  return (head - tail) & (N_CGNSTROBE - 1);
+}
+
+/*!
+ * @brief Shows the number of texts rejected for the lack of room in the queue.
+ * @return Number of rejected texts (saturates at \c BYTE_MAX).
+**/
+byte CgnStrobe::overflow() {
+  return lost;
+}
+
+/*!
+ * @brief Puts a character on the 8 data pins.
+ * @param c Character to be put.
+**/
+void CgnStrobe::put(byte c) {
+#if defined(__AVR__)
+  if (ported) {
+    if (flip) {
+      c = (c & 0xF0) >> 4 | (c & 0x0F) << 4;
+      c = (c & 0xCC) >> 2 | (c & 0x33) << 2;
+      c = (c & 0xAA) >> 1 | (c & 0x55) << 1;
+    }
+    *dataReg = c;
+    return;
+  }
+#endif
+  for (int j = 7; j >= 0; j--) {
+    digitalWrite(first + j, (c & _BV(j)) ? HIGH : LOW);
+  }
+}
+
+/*!
+ * @brief Sets the strobe pin.
+ * @param level Level of the strobe pin.
+**/
+void CgnStrobe::strobe(bool level) {
+#if defined(__AVR__)
+  if (ported) {
+    byte s = SREG;
+    cli();
+    if (level) {
+      *strobeReg |= strobeBit;
+    } else {
+      *strobeReg &= ~strobeBit;
+    }
+    SREG = s;
+    return;
+  }
+#endif
+  digitalWrite(first + 8, level);
+}
+
+/*!
+ * @brief Pushes a text into the queue for background strobing.
+ * @param txt Text to be queued.
+ * @param n Length of the text.
+ * @return Whether the whole text was queued.
+**/
+bool CgnStrobe::enqueue(const char *txt, byte n) {
+  byte h = head;
+  byte need = n + (term ? 1 : 0);
+  if (need > N_CGNSTROBE - 1 - pending()) {
+    if (lost < BYTE_MAX) {
+      lost++;
+    }
+    return false;
+  }
+  for (int i = 0; i < n; i++) {
+    q[h] = txt[i];
+    h = (h + 1) & (N_CGNSTROBE - 1);
+  }
+  if (term) {
+    q[h] = 0;
+    h = (h + 1) & (N_CGNSTROBE - 1);
+  }
+  head = h;
+  return true;
+}
+
+/*!
+ * @brief Advances background strobing by one interrupt cycle.
+ * @param obj CgnStrobe instance to be advanced.
+**/
+void CgnStrobe::hook(void *obj) {
+  CgnStrobe *self = (CgnStrobe *)obj;
+  byte t;
+
+  if (self->rest > 0 && --self->rest > 0) {
+    return;
+  }
+  if (self->phase == 1) {
+    // strobe has been up for a while
+    self->strobe(LOW);
+    self->phase = 2;
+    self->rest = self->ticks;
+    return;
+  }
+
+  t = self->tail;
+  if (t == self->head) {
+    if (self->phase == 2) {
+      self->put(0);
+      self->phase = 0;
+    }
+    return;
+  }
+  self->put(self->q[t]);
+  self->tail = (t + 1) & (N_CGNSTROBE - 1);
+  self->strobe(HIGH);
+  self->phase = 1;
+  self->rest = self->ticks;
+}
+
 void CgnStrobe::wait() {
   if (us) {
     delayMicroseconds(len);
@@ -76,4 +284,3 @@ void CgnStrobe::wait() {
     delay(len);
   }
 }
-
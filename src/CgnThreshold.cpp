@@ -0,0 +1,53 @@
+/*!
+ * @file CgnThreshold.cpp
+ * @brief Definition of CgnThreshold class.
+ * @author Kei Mochizuki
+ * @example Filter.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param highThreshold Value at or above which the state turns on.
+ * @param lowThreshold Value below which the state turns off.
+ * @param relaidPin Pin number for relaied output pin.
+ * @param debounceMs Delay intervened after a change in [ms].
+**/
+CgnThreshold::CgnThreshold(int highThreshold, int lowThreshold, byte relaidPin, byte debounceMs) : CgnLogger(false, relaidPin, debounceMs) {
+  set(highThreshold, lowThreshold);
+}
+
+/*!
+ * @brief Changes the thresholds.
+ * @param highThreshold Value at or above which the state turns on.
+ * @param lowThreshold Value below which the state turns off.
+ * @note The thresholds are swapped if given in the reverse order.
+ *       Equal thresholds make a single threshold without hysteresis.
+**/
+void CgnThreshold::set(int highThreshold, int lowThreshold) {
+  high = max(highThreshold, lowThreshold);
+  low = min(highThreshold, lowThreshold);
+}
+
+/*!
+ * @brief Updates the state by current value.
+ * @param v Current value.
+ * @return Time separation between current and last \c update in [ms].
+ * @note For a normal usage, this method is intended to be called
+ *       once, and only once, inside \c loop function.
+**/
+uint32_t CgnThreshold::update(int v) {
+  // between the thresholds, the state stays as it is
+  return CgnLogger::update(on() ? v >= low : v >= high);
+}
+
+/*!
+ * @brief Updates the state by the latest output of a filter.
+ * @param filter Filter of the thresholded signal.
+ * @return Time separation between current and last \c update in [ms].
+**/
+uint32_t CgnThreshold::update(CgnFilter &filter) {
+  return update(filter.get());
+}
@@ -16,31 +16,53 @@ CgnTimerAO::CgnTimerAO() {
 
 /*!
  * @brief Changes the analog output to a given value when determined time length has passed.
- * @return Difference between intended and actual timer action in [ms].
+ * @return Difference between intended and actual timer action in [ms] (or [us], see CgnClock).
  *         \c ULONG_MAX is returned when timer action did not occur.
  * @note For a normal usage, this method is intended to be called
  *       once inside \c loop function.
 **/
 uint32_t CgnTimerAO::update() {
   uint32_t d = ULONG_MAX;
-  if(millis() >= limit) {
+  // the scheduler may clear the deadline from its interrupt
+  byte s = CgnScheduler::lock();
+  if (cgnClock.reached(limit)) {
     analogWrite(pin, value);
-    d = millis() - limit;
+    d = cgnClock.raw() - limit;
     limit = ULONG_MAX;
   }
+  CgnScheduler::unlock(s);
   return d;
 }
 
 /*!
  * @brief Sets a timer to change the analog output after a given time length.
  * @param aoPin Pin number for analog-out.
- * @param timerMs Time length of timer in [ms].
+ * @param timerMs Time length of timer in [ms] (or [us], see CgnClock).
  * @param aoValue Value of the analog output to change to.
 **/
 void CgnTimerAO::set(byte aoPin, uint32_t timerMs, byte aoValue) {
+  byte s = CgnScheduler::lock();
   pin = aoPin;
-  limit = millis() + timerMs;
+  limit = cgnClock.after(timerMs);
   value = aoValue;
+  CgnScheduler::post(limit, fire, this);
+  CgnScheduler::unlock(s);
+}
+
+/*!
+ * @brief Changes the analog output on behalf of CgnScheduler class.
+ * @param obj CgnTimerAO instance that set the deadline.
+ * @param due Deadline registered to the scheduler.
+ * @return Whether the timer action was actually performed.
+**/
+bool CgnTimerAO::fire(void *obj, byte, uint32_t due) {
+  CgnTimerAO *self = (CgnTimerAO *)obj;
+  if (self->limit != due) {
+    return false;
+  }
+  analogWrite(self->pin, self->value);
+  self->limit = ULONG_MAX;
+  return true;
 }
 
 /*!
@@ -16,31 +16,53 @@ CgnTimerDO::CgnTimerDO() {
 
 /*!
  * @brief Changes the digital output to a given value when determined time length has passed.
- * @return Difference between intended and actual timer action in [ms].
+ * @return Difference between intended and actual timer action in [ms] (or [us], see CgnClock).
  *         \c ULONG_MAX is returned when timer action did not occur.
  * @note For a normal usage, this method is intended to be called
  *       once inside \c loop function.
 **/
 uint32_t CgnTimerDO::update() {
   uint32_t d = ULONG_MAX;
-  if(millis() >= limit) {
+  // the scheduler may clear the deadline from its interrupt
+  byte s = CgnScheduler::lock();
+  if (cgnClock.reached(limit)) {
     digitalWrite(pin, value);
-    d = millis() - limit;
+    d = cgnClock.raw() - limit;
     limit = ULONG_MAX;
   }
+  CgnScheduler::unlock(s);
   return d;
 }
 
 /*!
  * @brief Sets a timer to change the digital output after a given time length.
  * @param doPin Pin number for digital-out.
- * @param timerMs Time length of timer in [ms].
+ * @param timerMs Time length of timer in [ms] (or [us], see CgnClock).
  * @param doValue Value of the digital output to change to.
 **/
 void CgnTimerDO::set(byte doPin, uint32_t timerMs, bool doValue) {
+  byte s = CgnScheduler::lock();
   pin = doPin;
-  limit = millis() + timerMs;
+  limit = cgnClock.after(timerMs);
   value = doValue;
+  CgnScheduler::post(limit, fire, this);
+  CgnScheduler::unlock(s);
+}
+
+/*!
+ * @brief Changes the digital output on behalf of CgnScheduler class.
+ * @param obj CgnTimerDO instance that set the deadline.
+ * @param due Deadline registered to the scheduler.
+ * @return Whether the timer action was actually performed.
+**/
+bool CgnTimerDO::fire(void *obj, byte, uint32_t due) {
+  CgnTimerDO *self = (CgnTimerDO *)obj;
+  if (self->limit != due) {
+    return false;
+  }
+  digitalWrite(self->pin, self->value);
+  self->limit = ULONG_MAX;
+  return true;
 }
 
 /*!
@@ -21,28 +21,50 @@ CgnTone::CgnTone(byte tonePin) {
 
 /*!
  * @brief Stop the tone when finished determined time length of output.
- * @return Difference between intended and actual tone length in [ms].
+ * @return Difference between intended and actual tone length in [ms] (or [us], see CgnClock).
  *         \c ULONG_MAX is returned when termination of tone did not occur.
  * @note For a normal usage, this method is intended to be called
  *       once inside \c loop function.
 **/
 uint32_t CgnTone::update() {
   uint32_t d = ULONG_MAX;
-  if(millis() >= limit) {
+  // the scheduler may clear the deadline from its interrupt
+  byte s = CgnScheduler::lock();
+  if (cgnClock.reached(limit)) {
     noTone(pin);
-    d = millis() - limit;
+    d = cgnClock.raw() - limit;
     limit = ULONG_MAX;
   }
+  CgnScheduler::unlock(s);
   return d;
 }
 
 /*!
  * @brief Starts a tone out from a pin for determined time length.
- * @param toneMs Time length of output in [ms].
+ * @param toneMs Time length of output in [ms] (or [us], see CgnClock).
  * @param toneFreq Frequency of tone output in [Hz].
 **/
 void CgnTone::out(uint32_t toneMs, uint16_t toneFreq) {
+  byte s = CgnScheduler::lock();
   tone(pin, toneFreq);
-  limit = millis() + toneMs;
+  limit = cgnClock.after(toneMs);
+  CgnScheduler::post(limit, fire, this);
+  CgnScheduler::unlock(s);
+}
+
+/*!
+ * @brief Stops the tone on behalf of CgnScheduler class.
+ * @param obj CgnTone instance that set the deadline.
+ * @param due Deadline registered to the scheduler.
+ * @return Whether the tone was actually terminated.
+**/
+bool CgnTone::fire(void *obj, byte, uint32_t due) {
+  CgnTone *self = (CgnTone *)obj;
+  if (self->limit != due) {
+    return false;
+  }
+  noTone(self->pin);
+  self->limit = ULONG_MAX;
+  return true;
 }
 
@@ -12,7 +12,7 @@
  * @brief Constructor.
 **/
 CgnValtiel::CgnValtiel() {
-  from = millis();
+  from = cgnClock.now();
   last = from;
   n = 0;
   mx = 0;
@@ -23,7 +23,7 @@ CgnValtiel::CgnValtiel() {
  * @brief Start monitoring loop length by resetting the counter.
 **/
 void CgnValtiel::start() {
-  from = millis();
+  from = cgnClock.now();
   last = from;
   n = 0;
   mx = 0;
@@ -32,13 +32,13 @@ void CgnValtiel::start() {
 
 /*!
  * @brief Show average length of past loops and count up the counter.
- * @return Average length of \c loop in [ms].
+ * @return Average length of \c loop in [ms] (or [us], see CgnClock).
  * @note For a normal usage, this method is intended to be called
  *       once, and only once, inside \c loop function.
 **/
 float CgnValtiel::lap() {
   uint32_t cur;
-  cur = millis();
+  cur = cgnClock.now();
 
   n += 1;
   mx = max(mx, cur - last);
@@ -48,16 +48,16 @@ float CgnValtiel::lap() {
 }
 
 /*!
- * @brief Show maximal length of past loop in [ms].
- * @return Maximal length of \c loop in [ms].
+ * @brief Show maximal length of past loop.
+ * @return Maximal length of \c loop in [ms] (or [us], see CgnClock).
 **/
 uint32_t CgnValtiel::getMax() {
   return mx;
 }
 
 /*!
- * @brief Show minimal length of past loop in [ms].
- * @return Minimal length of \c loop in [ms].
+ * @brief Show minimal length of past loop.
+ * @return Minimal length of \c loop in [ms] (or [us], see CgnClock).
 **/
 uint32_t CgnValtiel::getMin() {
   return mn;
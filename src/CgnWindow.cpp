@@ -0,0 +1,258 @@
+/*!
+ * @file CgnWindow.cpp
+ * @brief Definition of CgnWindow class.
+ * @author Kei Mochizuki
+ * @example Window.ino
+**/
+
+#include "Arduino.h"
+#include "cgnuino.h"
+
+/*!
+ * @brief Constructor.
+ * @param debounceMs Delay intervened after a change of each window in [ms].
+**/
+CgnWindow::CgnWindow(byte debounceMs) {
+  used = 0;
+  circ = 0;
+  cur = 0;
+  pre = 0;
+  r = debounceMs;
+  last = millis();
+  for (int i = 0; i < N_CGNWINDOW; i++) {
+    cx[i] = 0;
+    cy[i] = 0;
+    hw[i] = 0;
+    hh[i] = 0;
+    rest[i] = 0;
+  }
+}
+
+/*!
+ * @brief Sets a rectangular window.
+ * @param i Index of the window.
+ * @param x Horizontal position of the center.
+ * @param y Vertical position of the center.
+ * @param halfWidth Half of the width (i.e., distance from the center to the sides).
+ * @param halfHeight Half of the height.
+ * @return Whether the window was set (\c false when @a i is out of range).
+**/
+bool CgnWindow::rect(byte i, int x, int y, uint16_t halfWidth, uint16_t halfHeight) {
+  if (i >= N_CGNWINDOW) {
+    return false;
+  }
+  cx[i] = x;
+  cy[i] = y;
+  hw[i] = halfWidth;
+  hh[i] = halfHeight;
+  used |= (uint32_t)1 << i;
+  circ &= ~((uint32_t)1 << i);
+  return true;
+}
+
+/*!
+ * @brief Sets a circular window.
+ * @param i Index of the window.
+ * @param x Horizontal position of the center.
+ * @param y Vertical position of the center.
+ * @param radius Radius of the window.
+ * @return Whether the window was set (\c false when @a i is out of range).
+**/
+bool CgnWindow::circle(byte i, int x, int y, uint16_t radius) {
+  if (!rect(i, x, y, radius, radius)) {
+    return false;
+  }
+  circ |= (uint32_t)1 << i;
+  return true;
+}
+
+/*!
+ * @brief Removes a window.
+ * @param i Index of the window.
+ * @note The window is regarded as not containing the position from now on,
+ *       without being reported by \c turnoff.
+**/
+void CgnWindow::remove(byte i) {
+  uint32_t b = (uint32_t)1 << i;
+  used &= ~b;
+  cur &= ~b;
+  pre &= ~b;
+}
+
+/*!
+ * @brief Tests a position against all the windows without debouncing.
+ * @param x Horizontal position.
+ * @param y Vertical position.
+ * @return Bitmask of the windows containing the position.
+ * @note A position on the edge of a window is regarded as inside.
+**/
+uint32_t CgnWindow::test(int x, int y) {
+  uint32_t m = 0;
+  for (byte i = 0; i < N_CGNWINDOW; i++) {
+    uint32_t b = (uint32_t)1 << i;
+    if (!(used & b)) {
+      continue;
+    }
+    int32_t dx = (int32_t)x - cx[i];
+    int32_t dy = (int32_t)y - cy[i];
+    uint32_t ax = (dx < 0) ? -dx : dx;
+    uint32_t ay = (dy < 0) ? -dy : dy;
+    if (ax > hw[i] || ay > hh[i]) {
+      continue;
+    }
+    // only the corners of the bounding square need the distance
+    if ((circ & b) && ax * ax + ay * ay > (uint32_t)hw[i] * hw[i]) {
+      continue;
+    }
+    m |= b;
+  }
+  return m;
+}
+
+/*!
+ * @brief Updates the states of the windows by a position.
+ * @param x Horizontal position.
+ * @param y Vertical position.
+ * @return Time separation between current and last \c update in [ms].
+ * @note For a normal usage, this method is intended to be called
+ *       once, and only once, inside \c loop function.
+**/
+uint32_t CgnWindow::update(int x, int y) {
+  uint32_t past, in, diff;
+  past = millis() - last;
+  last = millis();
+
+  in = test(x, y);
+  pre = cur;
+  if (r == 0) {
+    cur = in;
+    return past;
+  }
+  for (byte i = 0; i < N_CGNWINDOW; i++) {
+    if (rest[i] > past) {
+      rest[i] -= past;
+      continue;
+    }
+    rest[i] = 0;
+    diff = (cur ^ in) & ((uint32_t)1 << i);
+    if (diff) {
+      cur ^= diff;
+      rest[i] = r;
+    }
+  }
+  return past;
+}
+
+/*!
+ * @brief Updates the states of the windows by the latest samples of CgnAI.
+ * @param ai Analog input sampling the position.
+ * @param chX Channel index of the horizontal position.
+ * @param chY Channel index of the vertical position.
+ * @return Time separation between current and last \c update in [ms].
+**/
+uint32_t CgnWindow::update(CgnAI &ai, byte chX, byte chY) {
+  return update(ai.get(chX), ai.get(chY));
+}
+
+/*!
+ * @brief Checks whether the position is in @a i-th window.
+ * @param i Index of the window.
+ * @return Result of the examined state.
+**/
+bool CgnWindow::on(byte i) {
+  return cur & ((uint32_t)1 << i);
+}
+
+/*!
+ * @brief Checks whether the position is out of @a i-th window.
+ * @param i Index of the window.
+ * @return Result of the examined state.
+**/
+bool CgnWindow::off(byte i) {
+  return !on(i);
+}
+
+/*!
+ * @brief Checks whether the position entered @a i-th window in current loop.
+ * @param i Index of the window.
+ * @return Result of the examined state.
+**/
+bool CgnWindow::turnon(byte i) {
+  return turnonMask() & ((uint32_t)1 << i);
+}
+
+/*!
+ * @brief Checks whether the position left @a i-th window in current loop.
+ * @param i Index of the window.
+ * @return Result of the examined state.
+**/
+bool CgnWindow::turnoff(byte i) {
+  return turnoffMask() & ((uint32_t)1 << i);
+}
+
+/*!
+ * @brief Checks whether the state of @a i-th window changed from previous loop.
+ * @param i Index of the window.
+ * @return Result of the examined state.
+**/
+bool CgnWindow::change(byte i) {
+  return changeMask() & ((uint32_t)1 << i);
+}
+
+/*!
+ * @brief Checks whether the state of @a i-th window kept unchanged from previous loop.
+ * @param i Index of the window.
+ * @return Result of the examined state.
+**/
+bool CgnWindow::keep(byte i) {
+  return !change(i);
+}
+
+/*!
+ * @brief Shows the windows containing the position.
+ * @return Bitmask whose @a i-th bit is set while the position is in @a i-th window.
+**/
+uint32_t CgnWindow::onMask() {
+  return cur;
+}
+
+/*!
+ * @brief Shows the windows not containing the position.
+ * @return Bitmask whose @a i-th bit is set while the position is out of @a i-th window
+ *         (only for the windows set).
+**/
+uint32_t CgnWindow::offMask() {
+  return ~cur & used;
+}
+
+/*!
+ * @brief Shows the windows the position entered in current loop.
+ * @return Bitmask of the windows turned on.
+**/
+uint32_t CgnWindow::turnonMask() {
+  return cur & ~pre;
+}
+
+/*!
+ * @brief Shows the windows the position left in current loop.
+ * @return Bitmask of the windows turned off.
+**/
+uint32_t CgnWindow::turnoffMask() {
+  return ~cur & pre;
+}
+
+/*!
+ * @brief Shows the windows whose states changed from previous loop.
+ * @return Bitmask of the changed windows.
+**/
+uint32_t CgnWindow::changeMask() {
+  return cur ^ pre;
+}
+
+/*!
+ * @brief Shows the windows whose states kept unchanged from previous loop.
+ * @return Bitmask of the unchanged windows (only for the windows set).
+**/
+uint32_t CgnWindow::keepMask() {
+  return ~(cur ^ pre) & used;
+}
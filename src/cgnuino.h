@@ -15,10 +15,140 @@
 **/
 #define countof(array) (sizeof(array) / sizeof(array[0]))
 
+/*!
+ * @def CGN_MICROS
+ * @brief Whether cgnuino measures time in [us] instead of [ms] (see CgnClock).
+ * @note This must be given as a build flag, so that the library is compiled with it.
+ *       Defining it in a sketch alone does not change the library,
+ *       and such a sketch fails to link instead.
+**/
+#ifndef CGN_MICROS
+#define CGN_MICROS 0
+#endif
+
+/*!
+ * @def CGN_LOCAL
+ * @brief Storage class of the library-wide state
+ *        (thread-local in host builds so that each thread runs its own board).
+**/
+#if defined(CGN_HOST)
+#define CGN_LOCAL thread_local
+#else
+#define CGN_LOCAL
+#endif
+
 constexpr uint32_t ULONG_MAX = 4294967295; //!< Maximal value for unsigned long.
 constexpr byte BYTE_MAX = 255; //!< Maximal value for byte.
-constexpr byte N_CGNDI = 10; //!< Number of pins that can be simultaneously set for a CgnDI instance.
-constexpr byte N_CGNDO = 10; //!< Number of pins that can be simultaneously set for a CgnDO instance.
+constexpr uint32_t CGN_SPAN_MAX = 2147483647; //!< Maximal time length that can be waited for by cgnuino classes.
+constexpr byte N_CGNDI = 10; //!< Number of pins that can be simultaneously set for a CgnDI instance (see CgnDIBank for more).
+constexpr byte N_CGNDO = 10; //!< Number of pins that can be simultaneously set for a CgnDO instance (see CgnDOBank for more).
+constexpr byte N_CGNAI = 8; //!< Number of analog channels that can be scanned by a CgnAI instance.
+constexpr byte N_CGNSAMPLE = 32; //!< Number of analog samples buffered by CgnAI (must be a power of 2).
+constexpr byte N_CGNFILTER = 16; //!< Maximal number of samples averaged by CgnFilter.
+constexpr byte N_CGNCONTROL = 32; //!< Maximal number of characters in a command line received by CgnControl.
+constexpr byte N_CGNEDGE = 8; //!< Number of pin changes buffered by a CgnDI instance under interrupt (must be a power of 2).
+constexpr byte N_CGNTICK = 4; //!< Number of functions that can be simultaneously attached to the timer interrupt of CgnClock.
+constexpr byte N_CGNISR = 8; //!< Number of pins that can be simultaneously attached to interrupts by CgnDI instances.
+constexpr byte N_CGNPROFILE = 64; //!< Number of histogram bins of CgnProfiler (covering up to ~131 ms).
+constexpr byte N_CGNPACKET = 64; //!< Maximal number of bytes in a record of CgnPacket (including 3-byte header).
+constexpr byte N_CGNSTROBE = 32; //!< Number of characters queued by a CgnStrobe instance in background operation (must be a power of 2).
+constexpr byte N_CGNWINDOW = 16; //!< Number of target windows that can be set for a CgnWindow instance.
+constexpr byte N_CGNSCHEDULE = 16; //!< Number of deadlines that can be simultaneously registered to CgnScheduler.
+constexpr byte CGN_ON = 0; //!< Condition of CgnMachine fulfilled while the input is on.
+constexpr byte CGN_OFF = 1; //!< Condition of CgnMachine fulfilled while the input is off.
+constexpr byte CGN_TURNON = 2; //!< Condition of CgnMachine fulfilled when the input turns on.
+constexpr byte CGN_TURNOFF = 3; //!< Condition of CgnMachine fulfilled when the input turns off.
+constexpr byte CGN_CHANGE = 4; //!< Condition of CgnMachine fulfilled when the input changes.
+constexpr byte CGN_IIR = 0; //!< CgnFilter of first-order infinite impulse response (exponential smoothing).
+constexpr byte CGN_MEAN = 1; //!< CgnFilter of moving average.
+constexpr byte CGN_MEDIAN = 2; //!< CgnFilter of running median.
+constexpr byte CGN_CIC = 3; //!< CgnFilter of decimating cascaded integrator-comb.
+
+/*!
+ * @brief Samples analog inputs at a steady rate in background.
+ *
+ * Analog inputs can be read by \c analogRead function of Arduino,
+ * but it blocks for ~110 us on AVR boards until the conversion ends,
+ * and the sampling rate drifts with the length of your \c loop.
+ * This is not acceptable for signals from eye trackers or force sensors,
+ * whose time course itself is the data.
+ * CgnAI class instead lets the A/D converter run by itself
+ * and collects its results in the ADC-complete interrupt.
+ *
+ * At construction, give the first analog pin (e.g., \c A0)
+ * and the number of consecutive channels to be scanned
+ * (up to \c N_CGNAI).
+ * \c begin method starts the acquisition.
+ * Given a sampling rate in [Hz] for each channel,
+ * conversions are triggered by Timer1 at that rate
+ * (up to ~10 kHz in total across the channels at full accuracy,
+ * and up to ~35 kHz with reduced accuracy).
+ * Without the rate, the converter runs freely at ~9.6 kHz in total.
+ * \c end method stops it and gives the converter back to \c analogRead.
+ * Since Timer1 is taken over during triggered acquisition,
+ * PWM outputs on Timer1 (pins 9 and 10 on Uno, 11 and 12 on Mega)
+ * cannot be used together.
+ * Only one instance can run at a time.
+ *
+ * Every sample is stored in a ring buffer
+ * together with its channel and time stamp obtained by \c micros function.
+ * \c get method gives the latest value of a channel without waiting,
+ * and \c read method takes the buffered samples one by one
+ * (or a block of them at once) in the order of conversion.
+ * Up to \c N_CGNSAMPLE samples are buffered,
+ * so drain the buffer often enough (e.g., 3.2 ms at 10 kHz);
+ * samples that did not fit are counted by \c overflow method.
+ * When the acquisition is not running (or not supported by the board),
+ * \c get method falls back to \c analogRead.
+ *
+ * On AVR boards, the handler of the ADC-complete interrupt is defined
+ * only when \c CGN_AI_ISR is defined before cgnuino.h is included
+ * in your sketch, so that the interrupt is left to other libraries otherwise
+ * (then \c begin method returns \c false).
+ *
+ * \code
+ * #define CGN_AI_ISR
+ * #include "cgnuino.h"
+ *
+ * CgnAI eye = CgnAI(A0, 2);
+ * eye.begin(1000);
+ *
+ * int x = eye.get(0);
+ * int y = eye.get(1);
+ * \endcode
+**/
+class CgnAI {
+  public:
+    CgnAI(byte, byte = 1);
+    bool begin(uint16_t = 0);
+    void end();
+    int get(byte = 0);
+    uint32_t when(byte = 0);
+    byte available();
+    int read(byte * = NULL, uint32_t * = NULL);
+    byte read(int *, byte);
+    byte overflow();
+    static void convert();
+    static bool install();
+
+  private:
+    static CGN_LOCAL CgnAI *owner;
+    static bool installed;
+    void store(int);
+    byte first;
+    byte n;
+    bool freeRun;
+    byte cur;
+    byte mux;
+    volatile int latest[N_CGNAI];
+    volatile uint32_t stamp[N_CGNAI];
+    volatile int val[N_CGNSAMPLE];
+    volatile uint32_t valUs[N_CGNSAMPLE];
+    volatile byte valCh[N_CGNSAMPLE];
+    volatile byte head;
+    volatile byte tail;
+    volatile byte lost;
+};
 
 /*!
  * @brief Emits asynchroneous analog-out in a similar way to CgnDO class.
@@ -45,10 +175,112 @@ class CgnAO {
     void out(uint32_t, byte = 255);
 
   private:
+    static bool fire(void *, byte, uint32_t);
     byte pin;
     uint32_t limit;
 };
 
+/*!
+ * @brief Offers a shared, wrap-safe time base for all the timing classes.
+ *
+ * Classes in cgnuino library measure time and wait for deadlines
+ * in a common way provided by CgnClock class.
+ * You usually don't need to touch this class directly,
+ * but there are two things you may want to know.
+ *
+ * First, Arduino's \c millis function wraps around to zero
+ * after ~49.7 days.
+ * Naive comparison like \c millis() >= \c limit misbehaves near
+ * this wrap around, as well as when \c millis() + \c length overflows.
+ * CgnClock class computes deadlines by \c after method and checks them
+ * by \c reached method, which compare the signed difference of times
+ * so that they stay correct across the wrap around.
+ * The price is that a single time length must be shorter than
+ * \c CGN_SPAN_MAX (~24.8 days), and longer ones are clipped to it.
+ * (A length of \c ULONG_MAX, or \c -1, is reserved for "forever".)
+ * In addition, \c session method gives you an extended 64-bit clock
+ * that never wraps around, which is useful to time-stamp events
+ * during week-long sessions in home-cage experiments.
+ *
+ * Second, all the timing classes (CgnAO, CgnDO, CgnPeriod,
+ * CgnScheduler, CgnStopwatch, CgnTimerAO, CgnTimerDO, CgnTone and CgnValtiel)
+ * can run on \c micros function instead of \c millis.
+ * Define \c CGN_MICROS as \c 1 in your build flags
+ * (e.g., \c -DCGN_MICROS=1) to make them so.
+ * Then all the time lengths given to and returned from these classes
+ * are in microsecond, enabling sub-millisecond stimulus timing.
+ * Note that \c micros function wraps around in ~71.6 minutes,
+ * and thus \c CGN_SPAN_MAX corresponds to ~35.8 minutes in this mode.
+ *
+ * \code
+ * CgnDO led = CgnDO(13);
+ *
+ * led.out(0, 250); // 250 ms, or 250 us with CGN_MICROS
+ * \endcode
+ *
+ * Beware that \c #define in your sketch does not work,
+ * since the library files are compiled separately without it.
+ * In Arduino IDE, add the following lines to platform.local.txt
+ * next to platform.txt of your board package
+ * (or pass them to \c arduino-cli \c compile by \c --build-property).
+ * A sketch that defines \c CGN_MICROS by itself fails to link
+ * unless the library is also built with it,
+ * so the units never silently disagree.
+ *
+ * \code
+ * compiler.c.extra_flags=-DCGN_MICROS=1
+ * compiler.cpp.extra_flags=-DCGN_MICROS=1
+ * \endcode
+ *
+ * CgnClock class also lends a periodic timer interrupt to
+ * the classes that work in background (CgnScheduler and CgnStrobe).
+ * On AVR boards, it piggybacks on the compare-A interrupt of Timer0,
+ * which fires once in every ~1 ms without disturbing \c millis function.
+ * (In host builds, see extras/host, a 1-ms timer of the virtual board
+ * is used instead.)
+ * Up to \c N_CGNTICK functions can be attached to it at a time.
+ * Since another library may have its own handler of this interrupt,
+ * cgnuino defines the handler only when you ask for it
+ * by defining \c CGN_CLOCK_ISR before including cgnuino.h in your sketch.
+ * Without it, the timer interrupt is not available on AVR boards
+ * (i.e., \c begin(true) of CgnScheduler and \c async of CgnStrobe
+ * return \c false).
+ *
+ * \code
+ * #define CGN_CLOCK_ISR
+ * #include "cgnuino.h"
+ * \endcode
+**/
+class CgnClock {
+  public:
+    static uint32_t raw();
+    uint32_t now();
+    uint64_t session();
+    static uint32_t after(uint32_t);
+    static bool reached(uint32_t);
+    static bool reached(uint32_t, uint32_t);
+    static bool earlier(uint32_t, uint32_t);
+    static bool attach(void (*)(void *), void *);
+    static void detach(void (*)(void *), void *);
+    static void tick();
+    static bool install();
+#if CGN_MICROS
+    static bool inMicros();
+#endif
+
+  private:
+    struct Hook {
+      void (*fn)(void *);
+      void *obj;
+    };
+    static CGN_LOCAL Hook hooks[N_CGNTICK];
+    static bool installed;
+    uint32_t lo;
+    uint32_t hi;
+};
+
+extern CGN_LOCAL CgnClock cgnClock; //!< Global instance of CgnClock class.
+
 /*!
  * @brief Communicates with external control apprication running on a secondary PC.
  *
@@ -72,7 +304,15 @@ class CgnAO {
  * you can achieve it by sending command through a serial connection
  * and receiving it via CgnControl class.
  * CgnControl reads incoming serial text from Arduino's
- * standard \c Serial using \c readStringUntil method.
+ * standard \c Serial byte by byte into a fixed line buffer
+ * (up to \c N_CGNCONTROL characters).
+ * Only the bytes already received are consumed in each \c update
+ * (or \c poll, see below),
+ * so a line arriving in pieces never stalls your task
+ * (unlike \c readStringUntil method, which waits for the rest of a line
+ * for up to a second), and calling \c update on an idle port costs
+ * almost nothing.
+ * Lines longer than the buffer are discarded as a whole.
  * The received text is assumed to be composed of
  * two elements, "code" and "value", separated by a colon
  * (e.g., 1:2000, 2:3.14, or 5:trainingMode).
@@ -116,6 +356,11 @@ class CgnAO {
  * so you need to put appropriate type casting and
  * explicitly determine which variable should store that value
  * in each \c case branches.
+ * If you want to avoid String (and its heap allocation) at all,
+ * call \c poll method instead of \c update method,
+ * which returns whether a line has been received,
+ * and use \c getInt, \c getFloat or \c getText methods
+ * instead of \c getValue method.
  *
  * If received text is composed only one character,
  * CgnControl regards it as an ascii-coded integer.
@@ -149,13 +394,35 @@ class CgnControl {
   public:
     CgnControl(char = 10);
     String update();
+    bool poll();
     int getCode();
     String getValue();
+    const char *getText();
+    long getInt();
+    float getFloat();
 
   private:
+    void parse();
     int c;
-    String v;
     char eol;
+    char line[N_CGNCONTROL + 1];
+    byte len;
+    byte val;
+    bool done;
+    bool drop;
+};
+
+/*!
+ * @brief Buffer of pin changes captured in interrupt by CgnDI class (see \c attach of CgnDIBase).
+**/
+struct CgnEdges {
+  volatile uint32_t us[N_CGNEDGE]; //!< Times of the buffered changes in [us].
+  volatile byte ch[N_CGNEDGE]; //!< Indices of the changed inputs.
+  volatile bool level[N_CGNEDGE]; //!< States of the inputs after the changes.
+  volatile byte head; //!< Position written by the interrupt.
+  volatile byte tail; //!< Position read by \c update.
+  volatile byte lost; //!< Number of changes dropped by overflow.
+  uint32_t stamp[N_CGNISR]; //!< Times of the last changes of the inputs in [us].
 };
 
 /*!
@@ -213,7 +480,8 @@ class CgnControl {
  * At construction, CgnDI class prepares multiple pins as
  * pulled-up digital inputs using \c INPUT_PULLUP.
  * Maximal number of pins for one instance of this class
- * is determined by a constant \c N_CGNDI.
+ * is determined by a constant \c N_CGNDI
+ * (or by the template argument of CgnDIBank class, see below).
  * Every time \c update is called, CgnDI class read the
  * current values of the input pins.
  * These values can be checked by \c on and \c off methods,
@@ -257,10 +525,82 @@ class CgnControl {
  * In other words, if a change has occured to a given pin,
  * succeeding input from that same pin is omitted for a short period,
  * but inputs from other pins are regularly received and accessible.
+ *
+ * By default, each pin is read by \c digitalRead function one after another.
+ * This takes several microseconds per pin on AVR boards,
+ * and more importantly, pins are sampled at slightly different moments.
+ * Thus two levers pressed "together" may be registered in different loops.
+ * By calling \c batch method after construction,
+ * CgnDI class instead reads each underlying GPIO port register
+ * only once per \c update, so that all the pins sharing a port
+ * are sampled at the very same instant.
+ * Current and previous states are kept as packed bitmasks,
+ * which can be directly obtained by \c onMask, \c offMask,
+ * \c turnonMask, \c turnoffMask, \c changeMask and \c keepMask methods.
+ * The \c i-th bit of the returned value corresponds to the \c i-th input,
+ * so you can check all the response keys by a single call.
+ *
+ * \code
+ * CgnDI keys = CgnDI(22, 8);
+ * keys.batch();
+ *
+ * keys.update();
+ * if (keys.turnonMask() & 0b00000011) {
+ *   // either 1st or 2nd key was pressed
+ * }
+ * \endcode
+ *
+ * Since CgnDI class basically polls the pins,
+ * the timing of a response is quantized to whenever \c update is called,
+ * which can be several milliseconds late while your \c loop is
+ * blocked by CgnStrobe class or serial outputs.
+ * When all the pins have external interrupts
+ * (e.g., pins 2 and 3 on Arduino Uno), \c attach method
+ * makes CgnDI class capture every edge in an interrupt,
+ * together with its time stamp obtained by \c micros function.
+ * The edges are buffered in a small lock-free ring buffer (CgnEdges),
+ * which you declare and give to \c attach,
+ * and replayed at the next \c update.
+ * Thus \c turnon and \c turnoff methods work just as before,
+ * while \c when method tells you the exact time of the edge
+ * in microsecond, regardless of the jitter of your \c loop.
+ * Up to \c N_CGNEDGE edges can be buffered between two \c update calls.
+ * If more edges occured, they are counted by \c overflow method,
+ * and the pin states are re-synchronized by reading the pins.
+ *
+ * \code
+ * CgnDI lever = CgnDI(2);
+ * CgnEdges edges;
+ *
+ * void setup() {
+ *   lever.attach(edges);
+ * }
+ * \endcode
+ *
+ * CgnDI class keeps the states of \c N_CGNDI pins,
+ * however many of them are in use.
+ * CgnDIBank class instead takes the number of pins as a template argument,
+ * from 1 (costing no more than needed for a single lever)
+ * to 32 (e.g., for a large keyboard or a lick-o-meter array).
+ * The states are packed into bitmasks, and only a debounce counter
+ * is kept for each pin.
+ * (The time stamps of the edges are kept in CgnEdges instead,
+ * so that the instances not using \c attach do not pay for them.)
+ * All the methods are implemented in CgnDIBase class,
+ * so instances of different sizes share the same code,
+ * and any of them can be given to CgnMachine or CgnSnapshot classes.
+ *
+ * \code
+ * CgnDIBank<1> lever = CgnDIBank<1>(2);
+ * CgnDIBank<16> keys = CgnDIBank<16>(22);
+ * \endcode
 **/
-class CgnDI {
+class CgnDIBase {
   public:
-    CgnDI(byte, byte = 1, byte = NULL, byte = 2);
+    CgnDIBase(byte *, byte, byte, byte = 1, byte = 0, byte = 2);
+    bool batch(bool = true);
+    bool attach(CgnEdges &);
+    void detach();
     uint32_t update();
     bool on(byte = 0);
     bool off(byte = 0);
@@ -268,17 +608,78 @@ class CgnDI {
     bool turnoff(byte = 0);
     bool change(byte = 0);
     bool keep(byte = 0);
+    uint32_t onMask();
+    uint32_t offMask();
+    uint32_t turnonMask();
+    uint32_t turnoffMask();
+    uint32_t changeMask();
+    uint32_t keepMask();
+    uint32_t when(byte = 0);
+    byte overflow();
+
+  protected:
+    void rebind(byte *);
 
   private:
+    template <byte K> static void isr();
+    static CGN_LOCAL CgnDIBase *slotOwner[N_CGNISR];
+    static CGN_LOCAL byte slotCh[N_CGNISR];
+    static void (*const hooks[N_CGNISR])();
+    void edge(byte);
+    void toggle(byte, uint32_t);
+    uint32_t sample();
+    uint32_t all();
     byte first;
     byte n;
     byte relay;
     bool relaid;
-    bool cur[N_CGNDI];
-    bool pre[N_CGNDI];
+    uint32_t cur;
+    uint32_t pre;
     byte r;
-    byte rest[N_CGNDI];
+    byte *rest;
     uint32_t last;
+    uint32_t stamp;
+    bool ported;
+    CgnEdges *edges;
+};
+
+/*!
+ * @brief CgnDIBase class with its own storage of @a N pins.
+ * @tparam N Maximal number of pins (up to 32).
+**/
+template <byte N>
+class CgnDIBank : public CgnDIBase {
+  public:
+    CgnDIBank(byte firstPin, byte numberOfInputs = N, byte relaidPin = 0, byte debounceMs = 2) : CgnDIBase(store, N, firstPin, numberOfInputs, relaidPin, debounceMs) {
+      static_assert(N >= 1 && N <= 32, "CgnDIBank takes 1 to 32 pins");
+    }
+    CgnDIBank(const CgnDIBank &other) : CgnDIBase(other) {
+      adopt(other);
+    }
+    CgnDIBank &operator=(const CgnDIBank &other) {
+      detach();
+      CgnDIBase::operator=(other);
+      adopt(other);
+      return *this;
+    }
+
+  private:
+    // the copy must not refer to the storage of the original
+    void adopt(const CgnDIBank &other) {
+      for (byte i = 0; i < N; i++) {
+        store[i] = other.store[i];
+      }
+      rebind(store);
+    }
+    byte store[N];
+};
+
+/*!
+ * @brief CgnDIBase class with the storage of \c N_CGNDI pins (see CgnDIBase for the usage).
+**/
+class CgnDI : public CgnDIBank<N_CGNDI> {
+  public:
+    CgnDI(byte firstPin, byte numberOfInputs = 1, byte relaidPin = 0, byte debounceMs = 2) : CgnDIBank<N_CGNDI>(firstPin, numberOfInputs, relaidPin, debounceMs) {}
 };
 
 /*!
@@ -320,7 +721,8 @@ class CgnDI {
  * CgnDO class provides an easy way to overcome this problem.
  * At construction, CgnDO class prepares multiple pins as digital outputs.
  * Maximal number of pins for one instance of this class
- * is determined by a constant \c N_CGNDO.
+ * is determined by a constant \c N_CGNDO
+ * (or by the template argument of CgnDOBank class, see below).
  * To put out high digital output, use \c out method
  * by designating both the index of the digital-out pin
  * (but in count from the predetermined first output pin
@@ -346,17 +748,111 @@ class CgnDI {
  * from multiple pins with respectively different time lengths.
  * LchikaWave example will provide a simple example of this usage
  * of CgnDO class.
+ *
+ * The pins need not be consecutive.
+ * Instead of the first pin and the number of pins,
+ * you can give an array of any pins to the constructor
+ * (e.g., \c CgnDO(pins) with \c byte \c pins[] \c = \c {13, \c 8, \c 4, \c 2}),
+ * whose order gives the index of each output.
+ * On AVR boards, CgnDO class groups the pins by their GPIO ports at each output
+ * and writes the port registers directly.
+ * Then \c outMask method starts outputs of multiple pins together,
+ * which are given as a bitmask (\c i-th bit for \c i-th output).
+ * All the pins sharing a port go high by a single register write,
+ * and those on different ports follow within a few clock cycles
+ * (instead of ~5 us per pin by \c digitalWrite function).
+ * The pins turned on together are also lowered together.
+ * (Whatever pins are on, a CgnDO instance occupies only one deadline
+ * of CgnScheduler class, i.e., the earliest one.)
+ *
+ * \code
+ * const byte pins[] = {13, 8, 4, 2};
+ * CgnDO leds = CgnDO(pins);
+ *
+ * leds.outMask(0b1011, 500); // pins 13, 8 and 2 together
+ * \endcode
+ *
+ * CgnDO class keeps the deadlines of \c N_CGNDO pins,
+ * however many of them are in use
+ * (5 bytes for each pin: a 4-byte deadline and the pin number).
+ * CgnDOBank class instead takes the number of pins as a template argument,
+ * from 1 to 32.
+ * All the methods are implemented in CgnDOBase class,
+ * so instances of different sizes share the same code.
+ *
+ * \code
+ * CgnDOBank<1> reward = CgnDOBank<1>(13);
+ * CgnDOBank<24> cues = CgnDOBank<24>(22);
+ * \endcode
 **/
-class CgnDO {
+class CgnDOBase {
   public:
-    CgnDO(byte, byte = 1);
+    /*! @brief State of a pin kept by CgnDOBase class. */
+    struct Channel {
+      uint32_t limit; //!< Deadline of the output.
+      byte pin; //!< Pin number.
+    };
+
+    CgnDOBase(Channel *, byte, byte, byte = 1);
+    CgnDOBase(Channel *, byte, const byte *, byte);
     uint32_t update();
     void out(byte, uint32_t);
+    void outMask(uint32_t, uint32_t);
+
+  protected:
+    void rebind(Channel *);
 
   private:
-    byte first;
+    static bool fire(void *, byte, uint32_t);
+    void init();
+    void write(uint32_t, bool);
+    uint32_t all();
+    uint32_t next();
+    Channel *ch;
     byte n;
-    uint32_t limit[N_CGNDO];
+};
+
+/*!
+ * @brief CgnDOBase class with its own storage of @a N pins.
+ * @tparam N Maximal number of pins (up to 32).
+**/
+template <byte N>
+class CgnDOBank : public CgnDOBase {
+  public:
+    CgnDOBank(byte firstPin, byte numberOfOutputs = N) : CgnDOBase(store, N, firstPin, numberOfOutputs) {
+      static_assert(N >= 1 && N <= 32, "CgnDOBank takes 1 to 32 pins");
+    }
+    template <byte K>
+    CgnDOBank(const byte (&pins)[K]) : CgnDOBase(store, N, pins, K) {
+      static_assert(N >= 1 && N <= 32, "CgnDOBank takes 1 to 32 pins");
+    }
+    CgnDOBank(const CgnDOBank &other) : CgnDOBase(other) {
+      adopt(other);
+    }
+    CgnDOBank &operator=(const CgnDOBank &other) {
+      CgnDOBase::operator=(other);
+      adopt(other);
+      return *this;
+    }
+
+  private:
+    void adopt(const CgnDOBank &other) {
+      for (byte i = 0; i < N; i++) {
+        store[i] = other.store[i];
+      }
+      rebind(store);
+    }
+    Channel store[N];
+};
+
+/*!
+ * @brief CgnDOBase class with the storage of \c N_CGNDO pins (see CgnDOBase for the usage).
+**/
+class CgnDO : public CgnDOBank<N_CGNDO> {
+  public:
+    CgnDO(byte firstPin, byte numberOfOutputs = 1) : CgnDOBank<N_CGNDO>(firstPin, numberOfOutputs) {}
+    template <byte K>
+    CgnDO(const byte (&pins)[K]) : CgnDOBank<N_CGNDO>(pins) {}
 };
 
 /*!
@@ -388,6 +884,79 @@ class CgnData {
     String data;
 };
 
+/*!
+ * @brief Smooths a stream of analog samples by integer arithmetic.
+ *
+ * Signals of sensors such as piezo lick detectors and load cells
+ * are too noisy to be thresholded as they are.
+ * Smoothing them with \c float in your sketch
+ * takes much of the loop time on AVR boards, which have no FPU.
+ * CgnFilter class instead applies one of the following filters
+ * using only integer additions and shifts,
+ * each costing a constant time per sample with a constant memory.
+ * The kind of the filter is given at construction
+ * together with its parameter:
+ *
+ * - \c CGN_IIR: first-order infinite impulse response
+ *   (i.e., exponential smoothing), whose parameter @a k gives
+ *   the weight of a new sample as 1 / 2^k (e.g., \c 4 for 1/16).
+ *   The time constant is ~2^k samples.
+ *   The state is kept in fixed point with @a k fractional bits.
+ * - \c CGN_MEAN: moving average of the last @a n samples
+ *   (up to \c N_CGNFILTER), kept as a running sum.
+ *   A power of 2 for @a n saves a division.
+ * - \c CGN_MEDIAN: running median of the last 3 or 5 samples,
+ *   which removes spikes shorter than half of the window
+ *   while keeping the steps sharp.
+ * - \c CGN_CIC: second-order cascaded integrator-comb filter,
+ *   which averages blocks of @a r samples (with a triangular weight
+ *   over two blocks) and gives one output per block.
+ *   Use it to reduce the rate of a fast acquisition.
+ *
+ * Give each sample to \c put method, or let \c update method
+ * take a new sample of a channel of CgnAI class.
+ * They return \c true when a new output is available by \c get method
+ * (i.e., for every sample except for \c CGN_CIC).
+ * Note that \c update takes only the latest sample of the channel,
+ * so call \c put with every sample taken by \c read method of CgnAI
+ * when the acquisition is faster than your \c loop.
+ * The first sample after construction or \c reset fills the history,
+ * so that the output starts without a ramp from zero.
+ *
+ * The output is typically thresholded by CgnThreshold class.
+ *
+ * \code
+ * CgnAI lick = CgnAI(A0);
+ * CgnFilter smooth = CgnFilter(CGN_IIR, 3);
+ *
+ * smooth.update(lick);
+ * Serial.println(smooth.get());
+ * \endcode
+**/
+class CgnFilter {
+  public:
+    CgnFilter(byte = CGN_IIR, byte = 4);
+    bool put(int);
+    bool update(CgnAI &, byte = 0);
+    int get();
+    void reset();
+
+  private:
+    static int median3(int, int, int);
+    byte kind;
+    byte len;
+    byte shift;
+    byte phase;
+    bool fresh;
+    int out;
+    int hist[N_CGNFILTER];
+    byte at;
+    int32_t sum;
+    uint32_t integ[2];
+    uint32_t comb[2];
+    uint32_t stamp;
+};
+
 /*!
  * @brief Logs arbitrary boolean change in a similar way to CgnDI class.
  *
@@ -451,6 +1020,86 @@ class CgnLogger {
     uint32_t last;
 };
 
+/*!
+ * @brief Emits trial information as compact binary packets.
+ *
+ * CgnData and CgnRecord classes print trial information
+ * as tab-separated text, which is human readable but bulky.
+ * Numbers take 3--5 times their binary size,
+ * and dense per-frame logging easily saturates a serial link
+ * (e.g., ~11.5 kB/s at 115200 baud).
+ *
+ * CgnPacket class writes records as packed binary values instead.
+ * You declare a schema of the columns once at construction,
+ * by a string of type characters stored in flash memory:
+ * \c b / \c B for 8-bit, \c h / \c H for 16-bit and
+ * \c l / \c L for 32-bit signed / unsigned integers,
+ * and \c f for 32-bit floating point values
+ * (the same as Python's \c struct module).
+ * Tab-separated names of the columns can be also given.
+ * Then \c begin method emits a schema descriptor to the host,
+ * and each record is filled by \c append methods in the column order,
+ * and sent by \c out method.
+ * Values are converted to the type of the column they are appended to.
+ *
+ * \code
+ * CgnPacket pkt = CgnPacket(F("HLBf"), F("trial\trt\tcorrect\tx"));
+ *
+ * void setup() {
+ *   Serial.begin(115200);
+ *   pkt.begin();
+ * }
+ *
+ * // at the end of each trial
+ * pkt.append(trial);
+ * pkt.append(rt);
+ * pkt.append(correct);
+ * pkt.append(x);
+ * pkt.out();
+ * \endcode
+ *
+ * On the wire, each packet is composed of a kind byte
+ * (\c 'S' for the schema, \c 'R' for a record),
+ * its payload (a 16-bit sequence number and the little-endian fields
+ * for a record), and CRC-16/CCITT-FALSE of them.
+ * The packet is then encoded by Consistent Overhead Byte Stuffing (COBS)
+ * and terminated by \c 0x00, so that the host can resynchronize
+ * at any packet boundary and detect corrupted or lost packets.
+ * A decoder that turns the stream back into tab-separated rows
+ * is available as extras/decoder/cgndecode.cpp.
+**/
+class CgnPacket {
+  public:
+    CgnPacket(const __FlashStringHelper *, const __FlashStringHelper * = NULL);
+    void begin();
+    bool append(int);
+    bool append(unsigned int);
+    bool append(long);
+    bool append(unsigned long);
+    bool append(double);
+    bool out();
+    void clear();
+    bool overflow();
+
+  private:
+    char next();
+    bool put(uint32_t);
+    bool put(float);
+    static byte width(char);
+    byte peek(bool, uint16_t, uint16_t);
+    void frame(bool, uint16_t);
+    const char *types;
+    const char *names;
+    byte ncol;
+    uint16_t nname;
+    byte col;
+    byte buf[N_CGNPACKET];
+    byte len;
+    bool over;
+    uint16_t seq;
+    uint16_t crc;
+};
+
 /*!
  * @brief Temporally pauses task progression by digital-in pin state.
  *
@@ -531,9 +1180,9 @@ class CgnPause {
  * In this case, you can set the length of the period to \c -1.
  * Since the length of the period is defined as an unsigned long,
  * setting it to \c -1 cycles its value to the maximal value
- * of unsigned long (i.e., 4294967295 ms).
- * This corresponds to approximately 50 days,
- * virtually meaning that the period lasts forever without time limitation.
+ * of unsigned long (i.e., \c ULONG_MAX),
+ * which is reserved by CgnClock class to mean that
+ * the period lasts forever without time limitation.
  * (Actually this is the default behavior of the \c set method
  * when you omit designing the second argument.)
 **/
@@ -552,7 +1201,518 @@ class CgnPeriod {
 };
 
 /*!
- * @brief Measures time difference in milliseconds.
+ * @brief Profiles loop length by a histogram in microsecond resolution.
+ *
+ * CgnValtiel class tells you the average, maximal and minimal length
+ * of your \c loop, which is enough to check how quick it is.
+ * However, proving that your experimental rig meets its timing
+ * specification requires the distribution of the loop length,
+ * especially its tail (e.g., "99% of loops finish within 500 us").
+ *
+ * CgnProfiler class is used in the same way as CgnValtiel class
+ * (call \c lap method once in every \c loop),
+ * but it measures in microseconds with integer arithmetic only
+ * and counts each loop length into a histogram of a fixed size
+ * (\c N_CGNPROFILE bins of 16 bits).
+ * Lengths below 8 us have their own bins,
+ * and each octave above is divided into 4 bins
+ * (i.e., the resolution is within 25% of the length),
+ * covering up to ~131 ms.
+ * When a bin is about to overflow, all the bins are halved,
+ * so that the shape of the distribution is kept
+ * however long you profile.
+ * You can ask any percentile by \c percentile method
+ * (e.g., \c percentile(99) for the 99th percentile),
+ * which returns the upper bound of the corresponding bin.
+ * If you designate the target length of a loop
+ * (by constructor or \c setBudget method),
+ * \c overrun method counts loops exceeding it.
+ * \c out method prints all of these in a tab-separated line,
+ * optionally followed by the non-empty bins of the histogram.
+ *
+ * Besides the loop length, you can profile any part of your code
+ * by measuring its duration by yourself and passing it to \c add method.
+**/
+class CgnProfiler {
+  public:
+    CgnProfiler(uint32_t = ULONG_MAX);
+    void start();
+    uint32_t lap();
+    void add(uint32_t);
+    void setBudget(uint32_t);
+    uint32_t percentile(byte);
+    uint32_t getMean();
+    uint32_t getMax();
+    uint32_t getMin();
+    uint32_t overrun();
+    uint32_t count();
+    void out(bool = false);
+
+  private:
+    static byte bin(uint32_t);
+    static uint32_t lower(byte);
+    static uint32_t upper(byte);
+    uint16_t hist[N_CGNPROFILE];
+    uint32_t n;
+    uint64_t sum;
+    uint32_t mx;
+    uint32_t mn;
+    uint32_t budget;
+    uint32_t over;
+    uint32_t last;
+};
+
+/*!
+ * @brief Stores trial information in a fixed-size buffer without heap allocation.
+ *
+ * CgnData class is handy, but it relies on Arduino's String type.
+ * Every \c append allocates a new String and copies the whole row,
+ * so building a row of 30 columns copies bytes in O(n^2) manner.
+ * Moreover, on boards with only 2 KB of SRAM,
+ * repeated allocation fragments the heap,
+ * which eventually crashes your task in a long session.
+ *
+ * CgnRecord class is a drop-in alternative to CgnData class
+ * that stores a row in a static buffer whose size is fixed at compile time.
+ * Numbers are formatted in place by typed \c append methods,
+ * and texts in flash memory (e.g., \c F("correct")) can be appended
+ * without copying them into SRAM.
+ * The row is printed by \c out method in exactly the same format
+ * as CgnData class (i.e., each item preceded by the separator).
+ *
+ * \code
+ * CgnRecord<64> rec;
+ *
+ * rec.append(F("trial"));
+ * rec.append(trialNumber);
+ * rec.append(reactionTime);
+ * rec.append(angle, 3);
+ * rec.out();
+ * \endcode
+ *
+ * If an item does not fit in the remaining space,
+ * it is not appended at all (instead of being truncated),
+ * \c append returns \c false,
+ * and \c overflow method reports it until the next \c out or \c clear.
+ * The template argument of CgnRecord is the maximal number of characters
+ * in a row; one more byte is used for the terminating null character.
+ * All the methods are implemented in CgnRecordBase class,
+ * so instances of different sizes share the same code.
+**/
+class CgnRecordBase {
+  public:
+    CgnRecordBase(char *, uint16_t, char = 9);
+    bool append(const char *);
+    bool append(const __FlashStringHelper *);
+    bool append(char);
+    bool append(int);
+    bool append(unsigned int);
+    bool append(long);
+    bool append(unsigned long);
+    bool append(double, byte = 2);
+    void out();
+    void clear();
+    bool overflow();
+    const char *get();
+    uint16_t length();
+
+  protected:
+    void rebind(char *);
+
+  private:
+    bool put(char);
+    bool digits(unsigned long);
+    bool settle(uint16_t, bool);
+    char *buf;
+    uint16_t cap;
+    uint16_t len;
+    char sep;
+    bool over;
+};
+
+/*!
+ * @brief CgnRecordBase class with its own buffer of @a N characters.
+ * @tparam N Maximal length of the record in characters.
+**/
+template <uint16_t N>
+class CgnRecord : public CgnRecordBase {
+  public:
+    CgnRecord(char separatingChar = 9) : CgnRecordBase(store, N, separatingChar) {}
+    CgnRecord(const CgnRecord &other) : CgnRecordBase(other) {
+      adopt(other);
+    }
+    CgnRecord &operator=(const CgnRecord &other) {
+      CgnRecordBase::operator=(other);
+      adopt(other);
+      return *this;
+    }
+
+  private:
+    void adopt(const CgnRecord &other) {
+      memcpy(store, other.store, sizeof(store));
+      rebind(store);
+    }
+    char store[N + 1];
+};
+
+/*!
+ * @brief Services the deadlines of all output classes in one place.
+ *
+ * CgnDO, CgnAO, CgnTone, CgnTimerDO and CgnTimerAO classes
+ * remember when to terminate (or change) their outputs,
+ * and check it every time their \c update methods are called.
+ * This is simple and works well for a few outputs.
+ * However, when your task has dozens of outputs,
+ * most of the loop time is spent for checking deadlines
+ * that are almost never due.
+ * (CgnDO class even scans all of its pins one by one.)
+ *
+ * CgnScheduler class offers a central place for these deadlines.
+ * Once you call \c begin method of the global instance \c cgnScheduler,
+ * every output emitted by the classes above registers its deadline
+ * to the scheduler, which keeps them in a binary min-heap.
+ * Then \c cgnScheduler.update() in each \c loop terminates the outputs,
+ * and \c update methods of the output instances have nothing left to do
+ * as long as the scheduler can keep their deadlines (see below).
+ * Since only the earliest deadline is examined,
+ * the cost of \c update is proportional to the number of
+ * expired deadlines, not to the number of outputs.
+ * The lateness of actions can be monitored by the return value
+ * of \c update as well as by \c getMax method.
+ *
+ * \code
+ * CgnDO leds = CgnDO(8, 4);
+ * CgnTone buzzer = CgnTone(7);
+ *
+ * void setup() {
+ *   cgnScheduler.begin();
+ * }
+ *
+ * void loop() {
+ *   cgnScheduler.update();
+ *   leds.update();
+ *   buzzer.update();
+ * }
+ * \endcode
+ *
+ * Each output instance holds a single deadline in the scheduler
+ * (CgnDO class registers only the earliest one among its pins,
+ * and CgnDOFast class one for each pin),
+ * which is replaced whenever the output is emitted again.
+ * Up to \c N_CGNSCHEDULE deadlines can be registered at a time.
+ * If more instances have pending outputs, the exceeding deadlines
+ * are left to \c update methods of each output class.
+ * Thus keep calling them as before unless you are sure that
+ * your outputs fit in the scheduler.
+ * This is harmless and cheap while the scheduler is running,
+ * since an output terminated by either side is simply skipped by the other.
+ *
+ * Even with the scheduler, an output is kept on until your \c loop
+ * reaches \c update, so a 10 ms pulse can become 10--60 ms
+ * while the loop is busy with something else.
+ * If this is not acceptable, start the scheduler by \c begin(true).
+ * Then the deadlines are serviced in a hardware timer interrupt
+ * independent of your \c loop, with exactly the same API
+ * of the output classes.
+ * (On AVR boards, the compare-A interrupt of Timer0,
+ * which already runs \c millis function, is used for this purpose,
+ * once you define \c CGN_CLOCK_ISR before including cgnuino.h; see CgnClock.
+ * Thus the lateness of termination is reduced to the jitter of
+ * interrupt entry just after \c millis is counted up.
+ * Note that \c analogWrite to the PWM pin driven by Timer0 compare-A
+ * [pin 6 on Uno, pin 13 on Mega] shifts the phase of this interrupt,
+ * adding up to 1 ms of lateness.)
+ * In this mode, \c update method is no longer required to
+ * terminate the outputs, but still reports the lateness and number of
+ * actions performed since the last call.
+ * On boards without this facility, \c begin(true) returns \c false
+ * and the scheduler falls back to servicing in \c update.
+**/
+class CgnScheduler {
+  public:
+    bool begin(bool = false);
+    void end();
+    static bool post(uint32_t, bool (*)(void *, byte, uint32_t), void *, byte = 0);
+    static byte lock();
+    static void unlock(byte);
+    uint32_t update();
+    byte fired();
+    byte pending();
+    uint32_t getMax();
+    uint32_t until();
+
+  private:
+    struct Entry {
+      uint32_t due;
+      bool (*fire)(void *, byte, uint32_t);
+      void *obj;
+      byte ch;
+    };
+    static CGN_LOCAL CgnScheduler *current;
+    static CGN_LOCAL bool viaIsr;
+    static bool earlier(uint32_t, uint32_t);
+    static void hook(void *);
+    void service();
+    void remove(byte);
+    Entry heap[N_CGNSCHEDULE];
+    volatile byte n;
+    volatile byte nFired;
+    byte fires;
+    volatile uint32_t worst;
+    volatile uint32_t mx;
+};
+
+extern CGN_LOCAL CgnScheduler cgnScheduler; //!< Global instance of CgnScheduler class.
+
+/*!
+ * @brief Captures analog signals around an input event like an oscilloscope.
+ *
+ * To analyze licks, forces or eye movements around a response,
+ * the analog signal is needed from a while before to a while after the event.
+ * Streaming all the samples over the serial port would need
+ * far more bandwidth than the baud rate allows.
+ * CgnSnapshot class instead keeps recording the samples of CgnAI class
+ * into a circular buffer, and freezes a window of them
+ * around an edge of a CgnDI input (e.g., \c turnon of a lever),
+ * like the pre-trigger buffer of an oscilloscope.
+ *
+ * At construction, give the CgnAI and CgnDI instances,
+ * the index of the triggering input, its edge
+ * (\c CGN_TURNON, \c CGN_TURNOFF or \c CGN_CHANGE),
+ * the lengths before and after the edge in [ms],
+ * and a bitmask of the CgnAI channels to be recorded.
+ * Call \c update method in each loop after \c update of CgnDI.
+ * It takes all the samples buffered by CgnAI
+ * (so do not \c read them elsewhere; \c get still works),
+ * and returns \c true when the window after the edge is complete.
+ * The exact time of the edge is given by \c when method of CgnDI
+ * (in microseconds when the input is attached to an interrupt),
+ * and located among the samples by their time stamps.
+ *
+ * The frozen snapshot is emitted through CgnData class by \c out method,
+ * a row per call, so that it can be spread over the loops
+ * of the inter-trial interval.
+ * The first row consists of the time of the edge in [us],
+ * the interval of the samples in [us],
+ * and the numbers of samples before the edge and in total.
+ * Each following row begins with the index of its first sample
+ * relative to the edge (negative before the edge),
+ * followed by the values of the recorded channels in turn.
+ * When all the rows are emitted, \c out returns \c false
+ * and the recording starts again for the next edge.
+ * Edges during the capture and the output are ignored.
+ *
+ * \code
+ * CgnAI lick = CgnAI(A0);
+ * CgnDI lever = CgnDI(2);
+ * CgnSnapshot<600> snap = CgnSnapshot<600>(lick, lever, 0, CGN_TURNON, 200, 300);
+ * CgnData data;
+ *
+ * lever.update();
+ * snap.update();
+ * if (state.is(ITI)) {
+ *   snap.out(data);
+ * }
+ * \endcode
+ *
+ * The template argument of CgnSnapshot is the number of values
+ * kept in the buffer (2 bytes each),
+ * which must cover the window at the sampling rate for all the channels
+ * (e.g., 500 ms at 1 kHz for one channel needs 500).
+ * Otherwise the oldest part of the window is lost.
+ * All the methods are implemented in CgnSnapshotBase class,
+ * so instances of different sizes share the same code.
+**/
+class CgnSnapshotBase {
+  public:
+    CgnSnapshotBase(int *, uint16_t, CgnAI &, CgnDIBase &, byte = 0, byte = CGN_TURNON,
+                    uint16_t = 100, uint16_t = 100, byte = 1);
+    bool update();
+    bool ready();
+    bool out(CgnData &, byte = 16);
+    void arm();
+    uint32_t when();
+    uint32_t interval();
+
+  protected:
+    void rebind(int *);
+
+  private:
+    void store(int, byte, uint32_t);
+    bool triggered();
+    int *buf;
+    uint16_t cap;
+    CgnAI *ai;
+    CgnDIBase *di;
+    byte input;
+    byte edge;
+    uint32_t pre;
+    uint32_t post;
+    byte mask;
+    byte lead;
+    byte k;
+    byte pos;
+    byte phase;
+    uint32_t frames;
+    uint32_t tFirst;
+    uint32_t tLast;
+    uint32_t trig;
+    int32_t trigFrame;
+    uint32_t from;
+    uint32_t to;
+    uint32_t cursor;
+};
+
+/*!
+ * @brief CgnSnapshotBase class with its own buffer of @a N values.
+ * @tparam N Number of samples kept in the buffer (across the recorded channels).
+**/
+template <uint16_t N>
+class CgnSnapshot : public CgnSnapshotBase {
+  public:
+    CgnSnapshot(CgnAI &ai, CgnDIBase &di, byte input = 0, byte edge = CGN_TURNON,
+                uint16_t preMs = 100, uint16_t postMs = 100, byte channels = 1)
+        : CgnSnapshotBase(store, N, ai, di, input, edge, preMs, postMs, channels) {}
+    CgnSnapshot(const CgnSnapshot &other) : CgnSnapshotBase(other) {
+      adopt(other);
+    }
+    CgnSnapshot &operator=(const CgnSnapshot &other) {
+      CgnSnapshotBase::operator=(other);
+      adopt(other);
+      return *this;
+    }
+
+  private:
+    void adopt(const CgnSnapshot &other) {
+      memcpy(store, other.store, sizeof(store));
+      rebind(store);
+    }
+    int store[N];
+};
+
+/*!
+ * @brief Remembers current task state by integer ID and its time constraint.
+ *
+ * CgnState class works in the same way as CgnPeriod class,
+ * except that each task state is designated by a small integer (\c byte)
+ * instead of a String.
+ * CgnPeriod class is easy to use, but every call of \c is method
+ * builds a temporary String from the literal and compares it character
+ * by character, and every \c set copies another String into the heap.
+ * When a task loop checks a dozen of periods in every iteration,
+ * this takes a considerable fraction of loop time on AVR boards.
+ * With CgnState class, a state check is a single integer comparison
+ * and no heap memory is used at all.
+ *
+ * The IDs of the states are best defined by an \c enum
+ * (e.g., <tt>enum {REST, PRETRIAL, TRIAL, ITI};</tt>),
+ * so that you can still write readable conditional branching
+ * such as <tt>if (state.is(TRIAL) && state.expire())</tt>.
+ * The state just after construction is \c 0.
+ *
+ * For logging purpose, you can give the names of the states
+ * to the constructor as a tab-separated text in flash memory
+ * (e.g., <tt>F("rest\tpretrial\ttrial\titi")</tt>),
+ * in the order of their IDs.
+ * The names stay in flash memory and are only read
+ * by \c getName or \c printName methods.
+ * \c since method gives the time when the current state began,
+ * which is handy to record the timing of state transitions.
+**/
+class CgnState {
+  public:
+    CgnState(const __FlashStringHelper * = NULL);
+    void set(byte, uint32_t = -1);
+    bool is(byte);
+    bool expire();
+    byte get();
+    String getName();
+    size_t printName(Print &);
+    uint32_t since();
+    uint32_t until();
+
+  private:
+    const char *name();
+    const char *names;
+    byte state;
+    uint32_t from;
+    uint32_t limit;
+};
+
+/*!
+ * @brief Runs task states along a transition table in flash memory.
+ *
+ * With CgnPeriod or CgnState class, a task is written as
+ * a chain of <tt>if (state.is(...) && state.expire())</tt> branches
+ * in your \c loop function.
+ * This is readable for a simple task, but as the task grows,
+ * the chain becomes long, slow (every branch is tested in every loop),
+ * and error-prone (e.g., a forgotten \c else or a mistyped state).
+ *
+ * CgnMachine class is an extension of CgnState class
+ * that moves between the task states along tables you declare.
+ * The first table (\c CgnMachine::Stage) gives, for each state ID in order,
+ * the time limitation of the state (\c ULONG_MAX for no limitation)
+ * and the state to go when the limitation expires.
+ * The second table (\c CgnMachine::Rule) gives input conditions;
+ * each line says that in a source state,
+ * a condition on a channel of a CgnDI instance
+ * (\c CGN_ON, \c CGN_OFF, \c CGN_TURNON, \c CGN_TURNOFF or \c CGN_CHANGE,
+ * corresponding to the methods of CgnDI class)
+ * leads to a target state.
+ * The lines of the same source state must be written together,
+ * and they are tested in the written order.
+ * Both tables should be declared with \c PROGMEM,
+ * so that they consume no SRAM.
+ *
+ * Call \c set method once to enter the initial state,
+ * and then call \c step method with the CgnDI instance
+ * in every \c loop (after \c update of the CgnDI instance).
+ * \c step tests only the conditions of the current state
+ * (the position of which in the table is looked up once on transition),
+ * followed by the time limitation,
+ * and returns \c true when the state changed.
+ * You can then log the transition using the methods inherited
+ * from CgnState class (\c get, \c printName, \c since etc.)
+ * and \c from method telling the previous state.
+ * Actions at the entry of each state (e.g., turning on an LED)
+ * are written by yourself, typically as a \c switch on \c get
+ * when \c step returns \c true.
+**/
+class CgnMachine : public CgnState {
+  public:
+    /*! @brief Time limitation of a task state. */
+    struct Stage {
+      uint32_t ms; //!< Time limitation of the state in [ms] (or [us], see CgnClock).
+      byte next; //!< State to go when the time limitation expires.
+    };
+    /*! @brief Input condition leading to a task state. */
+    struct Rule {
+      byte from; //!< Source state where the condition is tested.
+      byte ch; //!< Input channel of CgnDI instance.
+      byte cond; //!< Kind of the condition (\c CGN_ON, \c CGN_TURNON etc.).
+      byte to; //!< Target state when the condition is fulfilled.
+    };
+
+    CgnMachine(const Stage *, byte, const Rule *, byte, const __FlashStringHelper * = NULL);
+    void set(byte);
+    bool step(CgnDIBase &);
+    byte from();
+    uint32_t transitions();
+
+  private:
+    static bool test(CgnDIBase &, byte, byte);
+    const Stage *stages;
+    const Rule *rules;
+    byte ns;
+    byte nr;
+    byte at;
+    byte prev;
+    uint32_t nStep;
+};
+
+/*!
+ * @brief Measures time difference in milliseconds (or microseconds).
  *
  * In behavioral tasks, it is incredibly common
  * for you to count elapsed time from a given origin.
@@ -661,18 +1821,123 @@ class CgnStopwatch {
  * By using CgnStrobe class with those kind of devices,
  * you can transmit texts easily and temporally more accurate way
  * compared with a USB serial connection.
+ *
+ * Note that \c out method waits for two strobe lengths per character
+ * until the whole text is emitted.
+ * With the default length of 5 us, this takes only a moment.
+ * However, if your acquisition device requires millisecond-order strobes,
+ * a text of 10 characters freezes your \c loop for tens of milliseconds,
+ * during which inputs are not sampled and outputs are not terminated.
+ * In such cases, call \c async method after construction.
+ * Then \c out method only pushes the text into a queue
+ * (up to \c N_CGNSTROBE - 1 characters) and returns immediately,
+ * and the characters are strobed one by one in a timer interrupt
+ * (see CgnClock class).
+ * You can check the progress by \c busy and \c pending methods.
+ * If the queue has no room for a whole text, the text is rejected,
+ * \c out returns \c ULONG_MAX, and \c overflow method counts it up.
+ * Since the interrupt fires once in every ~1 ms,
+ * each strobe phase lasts a whole number of milliseconds in this mode
+ * (i.e., at least 1 ms, even if the strobe length is set in microseconds).
+ * A character takes two phases, so the background operation
+ * emits a character in every 2 ms at the fastest
+ * (i.e., at most ~500 characters per second).
+ * This is far slower than the default 5-us strobes of \c out method
+ * without \c async, which emit a character in some tens of microseconds.
+ * Use \c async only when your device requires millisecond-order strobes
+ * anyway, and keep the default operation for short strobes.
+ *
+ * By default, the 8 data pins are set one by one with \c digitalWrite,
+ * so they settle at slightly different timings
+ * (some tens of microseconds in total on AVR boards).
+ * If the data pins are assigned to one whole hardware port
+ * (e.g., pin 22-29 for PORTA or pin 37-30 for PORTC on Arduino Mega),
+ * call \c parallel method after construction.
+ * Then each character is written by a single store to the port register
+ * followed by the strobe pin, without any skew between the bits,
+ * enabling much shorter strobes.
+ * The method returns \c false and leaves the default operation
+ * when the pins do not fit any single port.
 **/
 class CgnStrobe {
   public:
     CgnStrobe(byte, uint32_t = 5, bool = false);
+    bool parallel(bool = true);
+    bool async(bool = true);
     uint32_t out(String);
+    uint32_t out(const char *);
+    bool busy();
+    byte pending();
+    byte overflow();
 
   private:
+    static void hook(void *);
     void wait();
+    void put(byte);
+    void strobe(bool);
+    bool enqueue(const char *, byte);
     byte first;
 	uint32_t len;
     bool us;
     bool term;
+    bool queued;
+    uint16_t ticks;
+    volatile uint16_t rest;
+    volatile byte phase;
+    volatile byte q[N_CGNSTROBE];
+    volatile byte head;
+    volatile byte tail;
+    byte lost;
+    bool ported;
+#if defined(__AVR__)
+    volatile uint8_t *dataReg;
+    volatile uint8_t *strobeReg;
+    byte strobeBit;
+    bool flip;
+#endif
+};
+
+/*!
+ * @brief Detects crossings of an analog value with hysteresis.
+ *
+ * CgnLogger class tracks a boolean judged by yourself,
+ * e.g., whether an analog value exceeds a threshold.
+ * With a single threshold, however, noise around it
+ * makes the boolean alternate quickly at each crossing.
+ * CgnThreshold class extends CgnLogger class by two thresholds:
+ * it turns on when the value reaches the higher one,
+ * and turns off only after the value falls below the lower one.
+ * The band in between absorbs the noise smaller than its width,
+ * without delaying the crossing as a debounce does.
+ *
+ * Give the value to \c update method once in each loop,
+ * either as an integer or as the output of CgnFilter class.
+ * Then all the methods of CgnLogger class
+ * (\c on, \c turnon, \c turnoff etc.) can be used,
+ * as well as its relaid output pin and debounce.
+ *
+ * \code
+ * CgnAI lick = CgnAI(A0);
+ * CgnFilter smooth = CgnFilter(CGN_MEDIAN, 5);
+ * CgnThreshold licking = CgnThreshold(600, 400);
+ *
+ * smooth.update(lick);
+ * licking.update(smooth);
+ * if (licking.turnon()) {
+ *   // lick onset
+ * }
+ * \endcode
+**/
+class CgnThreshold : public CgnLogger {
+  public:
+    CgnThreshold(int, int, byte = 0, byte = 0);
+    void set(int, int);
+    uint32_t update(int);
+    uint32_t update(CgnFilter &);
+
+  private:
+    int high;
+    int low;
 };
 
 /*!
@@ -714,6 +1979,7 @@ class CgnTimerAO {
     uint32_t until();
 
   private:
+    static bool fire(void *, byte, uint32_t);
     byte pin;
     uint32_t limit;
     byte value;
@@ -758,6 +2024,7 @@ class CgnTimerDO {
     uint32_t until();
 
   private:
+    static bool fire(void *, byte, uint32_t);
     byte pin;
     uint32_t limit;
     bool value;
@@ -787,6 +2054,7 @@ class CgnTone {
     void out(uint32_t, uint16_t = 440);
 
   private:
+    static bool fire(void *, byte, uint32_t);
     byte pin;
     uint32_t limit;
 };
@@ -844,5 +2112,514 @@ class CgnValtiel {
 	uint32_t mn;
 };
 
+/*!
+ * @brief Tells which target windows contain a two-dimensional position.
+ *
+ * In fixation tasks, the gaze position from an eye tracker
+ * (or the position of a joystick or a touch) is compared
+ * with windows around the fixation point and the targets
+ * in every sample, to know when the subject acquired or broke fixation.
+ * Writing this in your sketch with \c float and \c sqrt
+ * takes much of the loop time on AVR boards.
+ * CgnWindow class keeps up to \c N_CGNWINDOW windows,
+ * either rectangular (by \c rect method) or circular (by \c circle method),
+ * given by their centers and (half) sizes in the unit of the position
+ * (e.g., raw values of \c analogRead).
+ * All the windows are tested by integer arithmetic
+ * (a multiplication is needed only for circles near their edges),
+ * and the result is a bitmask whose \c i-th bit tells
+ * whether the position is in \c i-th window.
+ *
+ * Give the position to \c update method once in each loop,
+ * either as x/y values or as two channels of CgnAI class.
+ * Then the same methods as CgnLogger class tell
+ * whether the position is in a window (\c on), has just entered it
+ * (\c turnon) or has just left it (\c turnoff), etc.,
+ * for each window or for all of them at once as bitmasks.
+ * Like CgnLogger, a debounce in [ms] can be given at construction,
+ * which keeps each window from changing its state again
+ * shortly after a change, e.g., during the noise of a blink.
+ *
+ * \code
+ * CgnAI eye = CgnAI(A0, 2);
+ * CgnWindow win = CgnWindow(20);
+ *
+ * win.circle(0, 512, 512, 40);   // fixation point
+ * win.rect(1, 800, 512, 60, 60); // target
+ *
+ * win.update(eye);
+ * if (win.turnoff(0)) {
+ *   // fixation broken
+ * }
+ * \endcode
+**/
+class CgnWindow {
+  public:
+    CgnWindow(byte = 0);
+    bool rect(byte, int, int, uint16_t, uint16_t);
+    bool circle(byte, int, int, uint16_t);
+    void remove(byte);
+    uint32_t test(int, int);
+    uint32_t update(int, int);
+    uint32_t update(CgnAI &, byte = 0, byte = 1);
+    bool on(byte = 0);
+    bool off(byte = 0);
+    bool turnon(byte = 0);
+    bool turnoff(byte = 0);
+    bool change(byte = 0);
+    bool keep(byte = 0);
+    uint32_t onMask();
+    uint32_t offMask();
+    uint32_t turnonMask();
+    uint32_t turnoffMask();
+    uint32_t changeMask();
+    uint32_t keepMask();
+
+  private:
+    int cx[N_CGNWINDOW];
+    int cy[N_CGNWINDOW];
+    uint16_t hw[N_CGNWINDOW];
+    uint16_t hh[N_CGNWINDOW];
+    byte rest[N_CGNWINDOW];
+    uint32_t used;
+    uint32_t circ;
+    uint32_t cur;
+    uint32_t pre;
+    byte r;
+    uint32_t last;
+};
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega168__)
+#define CGN_PINPORT "DDDDDDDDBBBBBBCCCCCC" //!< Port of each pin (Arduino Uno, Nano etc.).
+#define CGN_PINBIT "\0\1\2\3\4\5\6\7\0\1\2\3\4\5\0\1\2\3\4\5" //!< Bit of each pin in its port.
+#elif defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+#define CGN_PINPORT "EEEEGEHHHHBBBBJJHHDDDDAAAAAAAACCCCCCCCDGGGLLLLLLLLBBBBFFFFFFFFKKKKKKKK" //!< Port of each pin (Arduino Mega).
+#define CGN_PINBIT "\0\1\4\5\5\3\3\4\5\6\4\5\6\7\1\0\1\0\3\2\1\0\0\1\2\3\4\5\6\7\7\6\5\4\3\2\1\0\7\2\1\0\7\6\5\4\3\2\1\0\3\2\1\0\0\1\2\3\4\5\6\7\0\1\2\3\4\5\6\7" //!< Bit of each pin in its port.
+#endif
+
+/*!
+ * @brief Writes a pin whose number is known at compile time.
+ *
+ * \c digitalWrite and \c analogWrite functions look up
+ * the port and the timer of the pin from tables in flash memory,
+ * and turn off PWM of the pin, on every call.
+ * This takes ~4-5 us on AVR boards.
+ * When the pin number is a template argument,
+ * CgnPin class instead resolves them at compile time,
+ * so that a write compiles down to a single \c sbi or \c cbi instruction
+ * (or to a store with interrupts blocked for ports H to L of Arduino Mega).
+ * This is the building block of CgnDOFast and CgnAOFast classes.
+ *
+ * The pin map is known for ATmega328P/168 (Arduino Uno, Nano etc.)
+ * and ATmega2560/1280 (Arduino Mega) boards.
+ * On other boards (and in the host build),
+ * the methods fall back to \c digitalWrite and \c analogWrite.
+ * Note that PWM of a pin left by \c analogWrite is not turned off
+ * by \c write method, unlike \c digitalWrite.
+**/
+template <byte P>
+class CgnPin {
+  public:
+    static void write(bool);
+    static void pwm(byte);
+
+  private:
+    static volatile uint8_t *reg();
+};
+
+/*!
+ * @brief Emits asynchroneous analog-out from a pin fixed at compile time.
+ *
+ * CgnAOFast class is the same as CgnAO class,
+ * except that the pin number is given as a template argument.
+ * The duty rate is written to the compare register of the timer
+ * that drives the pin, instead of calling \c analogWrite function (see CgnPin).
+ *
+ * \code
+ * CgnAOFast<9> lamp = CgnAOFast<9>();
+ *
+ * lamp.out(500, 128);
+ * \endcode
+**/
+template <byte P>
+class CgnAOFast {
+  public:
+    CgnAOFast();
+    uint32_t update();
+    void out(uint32_t, byte = 255);
+
+  private:
+    static bool fire(void *, byte, uint32_t);
+    uint32_t limit;
+};
+
+/*!
+ * @brief Emits asynchroneous digital-out from pins fixed at compile time.
+ *
+ * CgnDO class keeps the first pin and the number of pins,
+ * and calls \c digitalWrite function for each output.
+ * Since its \c update method is typically called in every loop,
+ * the cost of \c digitalWrite (~4-5 us on AVR boards) adds up.
+ * CgnDOFast class takes the pin numbers as template arguments instead,
+ * in any order and from any ports (e.g., \c CgnDOFast<13, 8, 4>).
+ * Each output is then written by a single instruction (see CgnPin),
+ * which takes a fraction of a microsecond.
+ * The pins need not be consecutive, and their number is not limited
+ * by \c N_CGNDO.
+ *
+ * The usage is identical to CgnDO class:
+ * \c out method starts an output of @a i-th pin (in the order of the arguments)
+ * for a given time length, and \c update method (or CgnScheduler class)
+ * terminates it.
+ * Use CgnDO class when the pins are chosen at run time,
+ * e.g., from a command of CgnControl class.
+ *
+ * \code
+ * CgnDOFast<13, 8, 4> leds = CgnDOFast<13, 8, 4>();
+ *
+ * leds.update();
+ * leds.out(0, 500); // pin 13
+ * \endcode
+**/
+template <byte... Pins>
+class CgnDOFast {
+  public:
+    CgnDOFast();
+    uint32_t update();
+    void out(byte, uint32_t);
+
+  private:
+    static bool fire(void *, byte, uint32_t);
+    static void write(byte, bool);
+    template <byte P>
+    void lower(byte, uint32_t, uint32_t &);
+    uint32_t limit[sizeof...(Pins)];
+};
+
+/*!
+ * @brief Sets a pin to high or low voltage.
+ * @param high Whether to set the pin to high voltage.
+**/
+template <byte P>
+inline void CgnPin<P>::write(bool high) {
+#if defined(CGN_PINPORT)
+  static_assert(P < sizeof(CGN_PINPORT) - 1, "no such pin on this board");
+  constexpr byte mask = 1 << CGN_PINBIT[P];
+  volatile uint8_t *r = reg();
+  if (CGN_PINPORT[P] >= 'H') {
+    // out of the range of sbi and cbi, the port needs read-modify-write
+    byte s = SREG;
+    cli();
+    *r = high ? (*r | mask) : (*r & ~mask);
+    SREG = s;
+  } else if (high) {
+    *r |= mask;
+  } else {
+    *r &= ~mask;
+  }
+#else
+  digitalWrite(P, high ? HIGH : LOW);
+#endif
+}
+
+#if defined(CGN_PINPORT)
+#define CGN_PWM(pin, ocr, tccr, com) \
+  case pin: \
+    if (on) { \
+      ocr = duty; \
+      tccr |= _BV(com); \
+    } else { \
+      tccr &= ~_BV(com); \
+    } \
+    break;
+#endif
+
+/*!
+ * @brief Puts out PWM from a pin.
+ * @param duty Duty rate of pwm output within a range of [0, 255].
+ * @note As \c analogWrite function, duty rates of \c 0 and \c 255
+ *       disconnect the timer and hold the pin low and high.
+ *       Pins without timer output fall back to \c analogWrite.
+**/
+template <byte P>
+inline void CgnPin<P>::pwm(byte duty) {
+#if defined(CGN_PINPORT)
+  bool on = (duty != 0 && duty != 255);
+  byte s = SREG;
+  cli();
+  switch (P) {
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+    CGN_PWM(2, OCR3B, TCCR3A, COM3B1)
+    CGN_PWM(3, OCR3C, TCCR3A, COM3C1)
+    CGN_PWM(4, OCR0B, TCCR0A, COM0B1)
+    CGN_PWM(5, OCR3A, TCCR3A, COM3A1)
+    CGN_PWM(6, OCR4A, TCCR4A, COM4A1)
+    CGN_PWM(7, OCR4B, TCCR4A, COM4B1)
+    CGN_PWM(8, OCR4C, TCCR4A, COM4C1)
+    CGN_PWM(9, OCR2B, TCCR2A, COM2B1)
+    CGN_PWM(10, OCR2A, TCCR2A, COM2A1)
+    CGN_PWM(11, OCR1A, TCCR1A, COM1A1)
+    CGN_PWM(12, OCR1B, TCCR1A, COM1B1)
+    CGN_PWM(13, OCR0A, TCCR0A, COM0A1)
+    CGN_PWM(44, OCR5C, TCCR5A, COM5C1)
+    CGN_PWM(45, OCR5B, TCCR5A, COM5B1)
+    CGN_PWM(46, OCR5A, TCCR5A, COM5A1)
+#else
+    CGN_PWM(3, OCR2B, TCCR2A, COM2B1)
+    CGN_PWM(5, OCR0B, TCCR0A, COM0B1)
+    CGN_PWM(6, OCR0A, TCCR0A, COM0A1)
+    CGN_PWM(9, OCR1A, TCCR1A, COM1A1)
+    CGN_PWM(10, OCR1B, TCCR1A, COM1B1)
+    CGN_PWM(11, OCR2A, TCCR2A, COM2A1)
+#endif
+    default:
+      SREG = s;
+      analogWrite(P, duty);
+      return;
+  }
+  SREG = s;
+  if (!on) {
+    write(duty == 255);
+  }
+#else
+  analogWrite(P, duty);
+#endif
+}
+
+#if defined(CGN_PWM)
+#undef CGN_PWM
+#endif
+
+/*!
+ * @brief Finds the output register of the port of the pin.
+ * @return Pointer to the register (resolved at compile time).
+**/
+template <byte P>
+inline volatile uint8_t *CgnPin<P>::reg() {
+#if defined(CGN_PINPORT)
+  switch (CGN_PINPORT[P]) {
+#if defined(PORTA)
+    case 'A':
+      return &PORTA;
+#endif
+    case 'B':
+      return &PORTB;
+    case 'C':
+      return &PORTC;
+    case 'D':
+      return &PORTD;
+#if defined(PORTE)
+    case 'E':
+      return &PORTE;
+    case 'F':
+      return &PORTF;
+    case 'G':
+      return &PORTG;
+    case 'H':
+      return &PORTH;
+    case 'J':
+      return &PORTJ;
+    case 'K':
+      return &PORTK;
+    case 'L':
+      return &PORTL;
+#endif
+  }
+#endif
+  return NULL;
+}
+
+/*!
+ * @brief Consructor.
+**/
+template <byte P>
+CgnAOFast<P>::CgnAOFast() {
+  limit = ULONG_MAX;
+
+  pinMode(P, OUTPUT);
+  analogWrite(P, 0);
+}
+
+/*!
+ * @brief Stops the analog output when finished determined time length of output.
+ * @return Difference between intended and actual output lengths in [ms] (or [us], see CgnClock).
+ *         \c ULONG_MAX is returned when termination of output did not occur.
+ * @note For a normal usage, this method is intended to be called
+ *       once inside \c loop function.
+**/
+template <byte P>
+uint32_t CgnAOFast<P>::update() {
+  uint32_t d = ULONG_MAX;
+  // the scheduler may clear the deadline from its interrupt
+  byte s = CgnScheduler::lock();
+  if (cgnClock.reached(limit)) {
+    CgnPin<P>::pwm(0);
+    d = cgnClock.raw() - limit;
+    limit = ULONG_MAX;
+  }
+  CgnScheduler::unlock(s);
+  return d;
+}
+
+/*!
+ * @brief Starts an analog output from the pin for determined time length.
+ * @param aoMs Time length of output in [ms] (or [us], see CgnClock).
+ * @param aoDuty Duty rate of pwm output within a range of [0, 255].
+**/
+template <byte P>
+void CgnAOFast<P>::out(uint32_t aoMs, byte aoDuty) {
+  byte s = CgnScheduler::lock();
+  CgnPin<P>::pwm(aoDuty);
+  limit = cgnClock.after(aoMs);
+  CgnScheduler::post(limit, fire, this);
+  CgnScheduler::unlock(s);
+}
+
+/*!
+ * @brief Stops the analog output on behalf of CgnScheduler class.
+ * @param obj CgnAOFast instance that set the deadline.
+ * @param due Deadline registered to the scheduler.
+ * @return Whether the output was actually terminated.
+**/
+template <byte P>
+bool CgnAOFast<P>::fire(void *obj, byte, uint32_t due) {
+  CgnAOFast *self = (CgnAOFast *)obj;
+  if (self->limit != due) {
+    return false;
+  }
+  CgnPin<P>::pwm(0);
+  self->limit = ULONG_MAX;
+  return true;
+}
+
+/*!
+ * @brief Consructor.
+**/
+template <byte... Pins>
+CgnDOFast<Pins...>::CgnDOFast() {
+  static_assert(sizeof...(Pins) > 0, "no pin is given");
+  // each expansion is evaluated in the order of the pins
+  int each[] = {(pinMode(Pins, OUTPUT), CgnPin<Pins>::write(false), 0)...};
+  (void)each;
+  for (byte i = 0; i < sizeof...(Pins); i++) {
+    limit[i] = ULONG_MAX;
+  }
+}
+
+/*!
+ * @brief Lowers down the pins that finished determined time length of output.
+ * @return Difference between intended and actual output lengths in [ms] (or [us], see CgnClock).
+ *         \c ULONG_MAX is returned when termination of output did not occur.
+ * @note For a normal usage, this method is intended to be called
+ *       once inside \c loop function.
+**/
+template <byte... Pins>
+uint32_t CgnDOFast<Pins...>::update() {
+  uint32_t d = ULONG_MAX, cur = cgnClock.raw();
+  byte i = 0;
+  // the scheduler may clear the deadlines from its interrupt
+  byte s = CgnScheduler::lock();
+  int each[] = {(lower<Pins>(i++, cur, d), 0)...};
+  (void)each;
+  CgnScheduler::unlock(s);
+  return d;
+}
+
+/*!
+ * @brief Starts putting out from a pin for determined time length.
+ * @param i Index of DO pin (in the order of the template arguments) to emit digital output.
+ * @param outputMs Time length of output in [ms] (or [us], see CgnClock).
+**/
+template <byte... Pins>
+void CgnDOFast<Pins...>::out(byte i, uint32_t outputMs) {
+  if (i >= sizeof...(Pins)) {
+    return;
+  }
+  byte s = CgnScheduler::lock();
+  write(i, true);
+  limit[i] = cgnClock.after(outputMs);
+  CgnScheduler::post(limit[i], fire, this, i);
+  CgnScheduler::unlock(s);
+}
+
+/*!
+ * @brief Lowers down a pin on behalf of CgnScheduler class.
+ * @param obj CgnDOFast instance that emitted the output.
+ * @param i Index of DO pin to lower down.
+ * @param due Deadline registered to the scheduler.
+ * @return Whether the output was actually terminated.
+**/
+template <byte... Pins>
+bool CgnDOFast<Pins...>::fire(void *obj, byte i, uint32_t due) {
+  CgnDOFast *self = (CgnDOFast *)obj;
+  if (self->limit[i] != due) {
+    return false;
+  }
+  write(i, false);
+  self->limit[i] = ULONG_MAX;
+  return true;
+}
+
+/*!
+ * @brief Writes @a i-th pin.
+ * @param i Index of DO pin.
+ * @param high Whether to set the pin to high voltage.
+ * @note The index is compared with each pin in turn,
+ *       so that every write is inlined as a single instruction.
+**/
+template <byte... Pins>
+void CgnDOFast<Pins...>::write(byte i, bool high) {
+  byte k = 0;
+  int each[] = {((k++ == i) ? (CgnPin<Pins>::write(high), 0) : 0)...};
+  (void)each;
+}
+
+/*!
+ * @brief Lowers down a pin if its output finished.
+ * @param i Index of DO pin.
+ * @param cur Current time given by \c CgnClock::raw.
+ * @param d Lateness of the termination (updated when terminated).
+**/
+template <byte... Pins>
+template <byte P>
+void CgnDOFast<Pins...>::lower(byte i, uint32_t cur, uint32_t &d) {
+  if (cgnClock.reached(limit[i], cur)) {
+    CgnPin<P>::write(false);
+    d = cur - limit[i];
+    limit[i] = ULONG_MAX;
+  }
+}
+
+/*!
+ * @def CGN_CLOCK_ISR
+ * @brief Define this before including cgnuino.h in your sketch
+ *        to let CgnClock class handle the compare-A interrupt of Timer0.
+ * @note Define it in only one file of your sketch.
+**/
+#if defined(CGN_CLOCK_ISR) && defined(__AVR__) && defined(TIMER0_COMPA_vect)
+ISR(TIMER0_COMPA_vect) {
+  CgnClock::tick();
+}
+static const bool cgnClockIsr = CgnClock::install();
+#endif
+
+/*!
+ * @def CGN_AI_ISR
+ * @brief Define this before including cgnuino.h in your sketch
+ *        to let CgnAI class handle the ADC-complete interrupt.
+ * @note Define it in only one file of your sketch.
+**/
+#if defined(CGN_AI_ISR) && defined(__AVR__) && defined(ADC_vect)
+ISR(ADC_vect) {
+  CgnAI::convert();
+}
+static const bool cgnAIIsr = CgnAI::install();
+#endif
+
+#if CGN_MICROS
+// fails to link unless the library itself is built with CGN_MICROS
+static const bool cgnClockMicros = CgnClock::inMicros();
+#endif
+
 #endif
 